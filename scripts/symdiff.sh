@@ -0,0 +1,31 @@
+#!/bin/sh
+# Per-symbol size change between two symbol tables of one image
+#   symdiff.sh old.sym new.sym [title]
+# Tables are `nm --size-sort -S -t d` output (see the top-level Makefile).
+# Code and constants (t, r) count as flash, initialised data (d) as flash
+# and RAM, zeroed data (b) as RAM. Static symbols of the same name in
+# different files are summed.
+if [ ! -f "$1" ] || [ ! -f "$2" ]; then
+    echo "usage: $0 old.sym new.sym [title]" >&2
+    exit 1
+fi
+awk -v title="${3:-$2}" '
+    { type = tolower($3); key = type " " $4 }
+    FILENAME == ARGV[1] { old[key] += $2; keys[key] = 1; next }
+    { new[key] += $2; keys[key] = 1 }
+    END {
+        printf "---- %s ----\n", title
+        for (k in keys) {
+            d = new[k] - old[k]
+            if (d == 0)
+                continue
+            split(k, part, " ")
+            printf "%+8d %8d %8d  %s %s\n", d, old[k], new[k], part[1], part[2] | "sort -k1,1gr"
+            if (part[1] ~ /[tr]/ || part[1] == "d")
+                flash += d
+            if (part[1] ~ /[db]/)
+                ram += d
+        }
+        close("sort -k1,1gr")
+        printf "flash %+d bytes, RAM %+d bytes\n", flash, ram
+    }' "$1" "$2"
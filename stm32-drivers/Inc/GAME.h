@@ -2,7 +2,7 @@
 #ifndef GAME_H_
 #define GAME_H_
 
-void InitGame();
+void Init_Game();
 void Task_Game();
 
 #endif /* GAME_H_ */
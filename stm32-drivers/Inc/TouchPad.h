@@ -0,0 +1,106 @@
+#ifndef TOUCHPAD_H_
+#define TOUCHPAD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "display.h"
+#include "systick.h"
+
+// Single press on the Touchpad
+typedef enum { NONE=-1, MIN=0, N0=0, M1=1, N2=2, N3=3, N4=4, N5=5, N6=6,
+               N7=7, N8=8, N9=9, SHIFT=10, NEXT=11, MAX=11 } Press_t;
+
+// Numeric entry value
+typedef uint32_t Entry_t;
+
+// Electrode thresholds (counts of filtered data below the baseline),
+// debounce (extra samples, 0..7) and the calibration noise margin
+#ifndef TOUCH_THRESHOLD
+#define TOUCH_THRESHOLD 12  // Touch
+#endif
+#ifndef TOUCH_RELEASE
+#define TOUCH_RELEASE 6     // Release
+#endif
+#ifndef TOUCH_DEBOUNCE
+#define TOUCH_DEBOUNCE 1
+#endif
+#define TOUCH_PADS 12          // Electrodes
+#define TOUCH_CAL_SAMPLES 16   // Raw reads per calibration, no pad touched
+
+// Raw electrode data of the last raw read, for diagnostics
+typedef struct {
+    Time_t   time;                   // TimeNow() of the read
+    uint16_t filtered[TOUCH_PADS];   // Filtered data, 10 bits
+    uint16_t baseline[TOUCH_PADS];   // Baseline, same scale (8 MSBs read)
+    uint8_t  touch[TOUCH_PADS];      // Thresholds in use
+    uint8_t  release[TOUCH_PADS];
+    uint16_t noise[TOUCH_PADS];      // Filtered data peak to peak during the last calibration
+} TouchRaw_t;
+
+// Change of the pads held, bit n for pad n (Press_t). Several bits in
+// pressed are a chord: pads that went down between two reads.
+typedef struct {
+    Time_t   time;     // TimeNow() at the read that saw the change
+    uint16_t pads;     // Pads held after the change
+    uint16_t pressed;  // Pads that went down
+    uint16_t released; // Pads that went up
+} TouchEvent_t;
+// Events queue for the page open when they happen, so input typed on a
+// page waits for its app even after a page switch
+#define TOUCH_EVENTS 8  // Per page ring size, power of two
+
+// Gestures of a single pad, from the queued events and the time held
+typedef enum {
+    TOUCH_PRESS,   // Pad went down
+    TOUCH_DOUBLE,  // Second press of the pad within doubleTap of the first
+    TOUCH_LONG,    // Pad held for longPress, once per press
+    TOUCH_REPEAT   // Pad still held: after repeatDelay, then every period
+} GestureType_t;
+typedef struct {
+    GestureType_t type;
+    Press_t       pad;
+    Time_t        time;   // When it happened
+    uint16_t      count;  // Repeats so far in this hold (TOUCH_REPEAT)
+} Gesture_t;
+// Gesture timing of a page (ms), a zero time turns the gesture off.
+// The repeat period shrinks by repeatAccel percent per repeat down to
+// repeatMin.
+typedef struct {
+    Time_t   longPress;
+    Time_t   doubleTap;
+    Time_t   repeatDelay;
+    Time_t   repeatPeriod;
+    Time_t   repeatMin;
+    uint8_t  repeatAccel;
+    uint16_t repeatPads;  // Pads that repeat, bit per pad
+} TouchGestures_t;
+
+// Touch status read period (ms). With the controller's IRQ output wired
+// to TOUCH_INT_PIN (drivers_config.h) the status is read when it
+// changes, and the poll is only a fallback.
+#ifndef TOUCH_POLL_MS
+#ifdef TOUCH_INT_PIN
+#define TOUCH_POLL_MS 200
+#else
+#define TOUCH_POLL_MS 20
+#endif
+#endif
+
+void TouchEnable(void);              // Initialize touch sensor
+Press_t TouchInput(Page_t page);     // Get single pad press or repeat
+bool TouchEntry(Page_t page, Entry_t *num);  // Ongoing numeric entry, hold SHIFT to clear
+void TouchGestures(Page_t page, const TouchGestures_t *config);  // Kept, NULL for none
+bool TouchGesture(Page_t page, Gesture_t *g);  // Take the next gesture, if any
+bool TouchEvent(Page_t page, TouchEvent_t *e);  // Take the oldest event, if any (not mixed with gestures)
+uint16_t TouchPads(void);            // Pads held at the last read
+uint32_t TouchLost(void);            // Events dropped by full rings
+
+void TouchCalibrate(void);           // Measure the noise untouched, then set thresholds
+bool TouchCalibrating(void);
+void TouchSample(void);              // Request one raw read
+const TouchRaw_t *TouchRaw(void);    // Last raw read and thresholds
+
+void ScanTouchpad(void);             // Housekeeping: Check for Touchpad input
+void ClearTouchpad(void);            // Discard all queued events
+
+#endif // TOUCHPAD_H_
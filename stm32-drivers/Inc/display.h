@@ -0,0 +1,33 @@
+#ifndef DISPLAY_H_
+#define DISPLAY_H_
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include "drivers_config.h"
+
+typedef enum{ALARM = 0, CALC = 1, ENVIRO = 2, MOTOR = 3} Page_t;
+#define PAGES 5
+
+typedef enum {RED = 0xFF00000, GREEN = 0x00FF00, BLUE = 0x0000FF, YELLOW = 0xFFFF00, ORANGE = 0xFFA500, CYAN = 0x00FFFF, MAGENTA = 0xFF00FF, WHITE = 0xFFFFFF, OFF = 0x000000} Color_t;
+
+#ifndef NDISPLAY
+void DisplayEnable (void);
+void DisplayPrint (const Page_t page, const int line, const char *msg, ...);
+// As DisplayPrint, %f takes an int scaled by 10^precision ("%3.1f", 215)
+void DisplayPrintFixed (const Page_t page, const int line, const char *msg, ...);
+int DisplayFormat(char *buf, int size, bool fixed, const char *fmt, va_list args);
+void DisplayColor (const Page_t, const Color_t color);
+
+void UpdateDisplay(void);
+Page_t GetPage(void);
+#else
+// Image without the LCD: apps build unchanged and print nowhere
+#define DisplayEnable() ((void)0)
+#define DisplayPrint(page, line, ...) ((void)0)
+#define DisplayPrintFixed(page, line, ...) ((void)0)
+#define DisplayColor(page, color) ((void)0)
+#define UpdateDisplay() ((void)0)
+#define GetPage() ALARM
+#endif
+
+#endif /*DISPLAY_H_*/
@@ -0,0 +1,9 @@
+#ifndef DRIVERS_VERSION_H_
+#define DRIVERS_VERSION_H_
+
+// Version of the shared driver library, see stm32-drivers/README.
+// Bumped whenever a driver interface or the configuration options change.
+#define DRIVERS_VERSION_MAJOR 6
+#define DRIVERS_VERSION_MINOR 14
+
+#endif /* DRIVERS_VERSION_H_ */
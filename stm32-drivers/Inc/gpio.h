@@ -0,0 +1,81 @@
+#ifndef GPIO_H_
+#define GPIO_H_
+
+#include  <stdint.h>
+#include  <stdbool.h>
+#include "stm32l5xx.h"
+#include "drivers_config.h"
+
+#define GPIO_PORT_NUM(addr) (((unsigned)(addr) & 0xFC00) / 0x400)
+// Structure representing a single GPIO pin
+typedef struct {
+    GPIO_TypeDef *port; // GPIOA, GPIOB, etc.
+    int           bit;  // Bit index 0 .. 15
+} Pin_t;
+typedef enum {INPUT=0b00, OUTPUT=0b01, ALTFUNC=0b10, ANALOG=0b11} PinMode_t;
+typedef enum {LOW=0, HIGH=1} PinState_t;
+typedef enum {FALL=0, RISE=1} PinEdge_t;
+typedef enum {PP=0, OD=1} PinType_t;
+typedef enum {S0=0b00, S1=0b01, S2=0b10, S3=0b11} PinSpeed_t;
+typedef enum {NOPUPD=0b00, PU=0b01, PD=0b10} PinPUPD_t;
+
+// Edge event recorded by the EXTI interrupt handler
+typedef struct {
+    uint32_t time;  // Cycle count at interrupt entry, see TimeNowCycles
+    uint8_t  port;  // Port index, 0 = GPIOA
+    uint8_t  bit;   // Bit index 0 .. 15 (EXTI line)
+    uint8_t  edge;  // PinEdge_t
+} GPIO_Event_t;
+#define GPIO_EVENTS 128  // Ring size, power of two
+#define GPIO_SUBSCRIBERS 16  // Callbacks registered at once, all lines
+
+// Event queue statistics, counters only grow
+typedef struct {
+    uint32_t events;         // Edges delivered to callbacks
+    uint32_t overflows[16];  // Edges lost to a full ring, per EXTI line
+    uint32_t maxDepth;       // Most edges waiting at once
+} GPIO_EventStats_t;
+
+// Output levels of several pins, applied with one store per port
+// Built once by GPIO_Group(), the masks are ready to write to BSRR
+#define GPIO_GROUP_PORTS 4  // Ports one group can span
+typedef struct {
+    int           ports;
+    GPIO_TypeDef *port[GPIO_GROUP_PORTS];
+    uint32_t      bsrr[GPIO_GROUP_PORTS];  // Set bits 15:0, reset bits 31:16
+} PinGroup_t;
+
+// I/O expander push button read period (ms), a fallback only when the
+// expander interrupt line is wired to IOX_INT_PIN
+#ifndef IOX_POLL_MS
+#ifdef IOX_INT_PIN
+#define IOX_POLL_MS 1000
+#else
+#define IOX_POLL_MS 20
+#endif
+#endif
+
+extern GPIO_TypeDef IOX_GPIO_Regs;
+#define GPIOX (&IOX_GPIO_Regs)
+
+void GPIO_Enable(Pin_t pin);
+void GPIO_PortEnable(GPIO_TypeDef*port);
+void GPIO_Mode(Pin_t pin, PinMode_t mode);
+void GPIO_Config(Pin_t pin, PinType_t ot, PinSpeed_t osp, PinPUPD_t pupd);
+void GPIO_AltFunc(Pin_t pin, int af);
+PinState_t GPIO_Input(Pin_t pin);
+uint16_t GPIO_PortInput(GPIO_TypeDef*port);
+void GPIO_Output(Pin_t pin, PinState_t state);
+void GPIO_PortOutput(GPIO_TypeDef *port, uint16_t states);
+void GPIO_Toggle(Pin_t pin);
+PinGroup_t GPIO_Group(const Pin_t *pins, int count, uint32_t levels);  // Bit n of levels for pins[n]
+void GPIO_GroupWrite(const PinGroup_t *group);
+bool GPIO_Callback(Pin_t pin, void (*func)(void), PinEdge_t edge);  // Add a subscriber
+void GPIO_RemoveCallback(Pin_t pin, void (*func)(void), PinEdge_t edge);
+bool GPIO_GetEvent(GPIO_Event_t *e);  // Take the oldest event, if any
+const GPIO_EventStats_t *GPIO_EventStats(void);
+void ServiceGPIOEvents(void);  // Run callbacks of queued events, from main loop
+
+void UpdateIOExpanders(void);
+
+#endif /* GPIO_H_ */
@@ -0,0 +1,59 @@
+#ifndef I2C_H_
+#define I2C_H_
+
+#include <stdbool.h>
+#include "stm32l5xx.h"
+#include "gpio.h"
+
+// I2C bus connection
+typedef struct {
+    I2C_TypeDef *iface;
+    Pin_t      pinSDA;
+    Pin_t      pinSCL;
+}  I2C_Bus_t;
+
+extern I2C_Bus_t LeafyI2C; // I2C bus on Leafy mainboard
+
+// Transfer priority classes, higher classes go first. A waiting
+// transfer is served anyway once I2C_AGING transfers have started ahead
+// of it, so a busy class cannot starve the others.
+typedef enum {
+    I2C_BULK = 0,    // Display text, default
+    I2C_CONTROL = 1, // Backlight, LEDs, device setup
+    I2C_INPUT = 2    // Touchpad and button reads
+} I2C_Priority_t;
+#define I2C_CLASSES 3
+#define I2C_AGING 4
+
+// Outcome of a transfer, valid once busy is cleared
+typedef enum {
+    I2C_OK = 0,
+    I2C_NACK,      // Target did not acknowledge address or data
+    I2C_BUS_ERROR, // Misplaced START/STOP, arbitration lost or overrun
+    I2C_TIMEOUT    // No completion within I2C_TIMEOUT_MS, bus was reset
+} I2C_Status_t;
+#define I2C_TIMEOUT_MS 20
+
+// I2C transfer record
+typedef struct I2C_Xfer_t {
+    I2C_Bus_t    *bus;
+    uint8_t       addr;
+    uint8_t       *data;
+    int           size;
+    bool      stop;
+    volatile bool busy;  // Queued or in progress, cleared by interrupt handler
+    struct I2C_Xfer_t *next; // Pointer to next transfer in queue
+    bool      dma;   // Move data by DMA instead of per-byte interrupts
+    void    (*callback)(struct I2C_Xfer_t *p); // Completion (interrupt context), optional
+    I2C_Priority_t priority; // A read queued by I2C_RequestRead() takes the write's class
+    volatile I2C_Status_t status; // Set by the driver
+} I2C_Xfer_t;
+
+void I2C_Enable(I2C_Bus_t bus);
+bool I2C_Request(I2C_Xfer_t *p); // False if p is still busy
+bool I2C_RequestRead(I2C_Xfer_t *wr, I2C_Xfer_t *rd); // Write without stop, then read, as one unit
+
+void ServiceI2CRequests(void);
+
+#endif /* I2C_H_ */
+
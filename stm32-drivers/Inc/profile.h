@@ -0,0 +1,36 @@
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <stdint.h>
+#include "drivers_config.h"
+#include "systick.h"
+
+// Timing statistics of a named code region, in CPU cycles
+typedef struct {
+    const char *name;
+    uint32_t    count;
+    uint32_t    min;
+    uint32_t    max;
+    uint64_t    total;  // Sum of all samples, for the mean
+} Profile_t;
+
+#define PROFILE_REGIONS 16  // Size of the static region table
+
+// Time a code region; name is a plain identifier unique within the block.
+// The region's table slot is looked up once, so each pass costs two
+// cycle counter reads and a few compares. Define NPROFILE to compile out.
+#ifndef NPROFILE
+#define PROFILE_BEGIN(name) \
+    static Profile_t *prof_##name = NULL; \
+    uint32_t prof_start_##name = TimeNowCycles()
+#define PROFILE_END(name) \
+    ProfileRecord(&prof_##name, #name, TimeNowCycles() - prof_start_##name)
+#else
+#define PROFILE_BEGIN(name)
+#define PROFILE_END(name)
+#endif
+
+void ProfileRecord(Profile_t **region, const char *name, uint32_t cycles);
+void ProfileDump(void);   // Print all regions over ITM and reset them
+
+#endif /* PROFILE_H_ */
@@ -0,0 +1,24 @@
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <stdint.h>
+#include "systick.h"
+
+// Scheduled task, one entry per row of the task table
+typedef struct {
+    const char *name;      // Name shown in reports
+    void      (*func)(void);
+    Time_t      period;    // Release interval in ms
+    Time_t      phase;     // Offset of first release after start, in ms
+    int         priority;  // Lower value runs first when released together
+    Time_t      due;       // Next release time
+    uint32_t    wcet;      // Worst-case execution time in CPU cycles
+    uint32_t    runs;      // Number of releases
+} Task_t;
+
+void StartScheduler(Task_t *table, int count);  // Sort table and set first releases
+void RunDueTasks(void);                         // Run every task that is due
+Time_t NextDueTime(void);                       // Earliest release of any task
+void ReportTaskTimes(void);                     // Print WCET and CPU load
+
+#endif /* SCHEDULER_H_ */
@@ -12,7 +12,14 @@ Pin_t pinMOSI; // MCU pin for MOSI/SI
 Pin_t pinNSS; // MCU pin for NSS/CSB
 } SPI_Bus_t;
 extern SPI_Bus_t EnvSPI; // SPI bus for Environmental Sensor
-typedef enum {RX=1, TX=0} Direction_t;
+typedef enum {RX=1, TX=0, DUPLEX=2} Direction_t; // DUPLEX: data is sent and overwritten
+// Outcome of a transfer, valid once busy is cleared
+typedef enum {
+SPI_OK = 0,
+SPI_DMA_ERROR, // Bus error on a DMA memory access
+SPI_TIMEOUT // No completion within SPI_TIMEOUT_MS, controller was reset
+} SPI_Status_t;
+#define SPI_TIMEOUT_MS 20
 // SPI transfer record
 typedef struct SPI_Xfer_t {
 SPI_Bus_t *bus; // Pointer to SPI bus structure
@@ -22,8 +29,11 @@ int size; // Total number of bytes in transfer
 bool last; // Last transfer in combined sequence
 volatile bool busy; // Busy indicator (queued or in progress)
 struct SPI_Xfer_t *next; // Pointer to next transfer in queue
+uint32_t start; // Cycle count when requested
+uint32_t latency; // Cycles from request to completion
+volatile SPI_Status_t status; // Set by the driver
 } SPI_Xfer_t;
 void SPI_Enable(SPI_Bus_t bus); // Enable SPI bus connection
-void SPI_Request(SPI_Xfer_t *p); // Request a new transfer
+bool SPI_Request(SPI_Xfer_t *p); // Request a new transfer, false if p is still busy
 void ServiceSPIRequests(void); // Called from main loop
 #endif /* SPI_H_ */
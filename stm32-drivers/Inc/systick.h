@@ -2,16 +2,24 @@
 
 #ifndef SYSTICK_H_
 #define SYSTICK_H_
+#include <stdint.h>
 #include "stm32l5xx.h"
+#include "sysclk.h"
 
 typedef unsigned int Time_t;
 #define TIME_MAX (Time_t)(-1)
 
+// CPU cycle counter rate
+#define CYCLES_PER_US ((uint32_t)(SYSCLK_FREQ / 1e6))
+
 void StartSysTick();
 void WaitForSysTick();
+void SleepUntil(Time_t wake);
 void msDelay(int t);
 Time_t TimeNow();
 Time_t TimePassed(Time_t since);
+uint32_t TimeNowCycles(void); // Differences are valid across one wrap (89 s)
+Time_t TimeNowUs(void);
 
 
 #endif /* SYSTICK_H_ */
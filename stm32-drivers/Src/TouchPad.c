@@ -0,0 +1,351 @@
+/*
+ * TouchPad.c
+ *
+ *  Created on: Oct 30, 2025
+ *      Author: ashay020
+ */
+
+
+// Touchpad driver
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "touchpad.h"
+#include "systick.h"
+#include "i2c.h"
+#include "display.h"
+#include "gpio.h"
+static bool enabled = false;
+// I2C write transfers to initialize Touchpad sensor
+// Soft reset: defaults and stop mode, so the configuration is accepted
+static uint8_t txReset[2] = {0x80, 0x63};
+static I2C_Xfer_t PadReset = {&LeafyI2C, 0xB4, txReset, 2, 1, 0, NULL, false, NULL, I2C_CONTROL};
+// Configuration registers 0x2B..0x5E in one auto-increment burst. The
+// Electrode Configuration Register (ECR) comes last and starts the scan.
+#define ECR_RUN 0x8F // Baseline tracking from the first sample, 12 electrodes
+#define AFE1 0x10 // 6 samples first filter, 16 uA charge current
+#define AFE2 0x20 // 0.5 us charge time, 4 samples second filter, 1 ms period
+typedef struct {
+ uint8_t addr; // First register
+ uint8_t filter[11]; // Baseline filter rising, falling, touched (MHD, NHD, NCL, FDL)
+ uint8_t prox[11]; // Proximity filter, unused
+ uint8_t thresholds[TOUCH_PADS][2]; // Touch, release per electrode
+ uint8_t proxThresholds[2];
+ uint8_t debounce; // Release 6:4, touch 2:0
+ uint8_t afe1;
+ uint8_t afe2;
+ uint8_t ecr;
+} PadConfig_t;
+#define THRESHOLDS {[0 ... TOUCH_PADS-1] = {TOUCH_THRESHOLD, TOUCH_RELEASE}}
+static PadConfig_t txConfig = {0x2B,
+ {0x01, 0x01, 0x0E, 0x00, 0x01, 0x05, 0x01, 0x00, 0x00, 0x00, 0x00}, {0},
+ THRESHOLDS, {0, 0}, TOUCH_DEBOUNCE << 4 | TOUCH_DEBOUNCE, AFE1, AFE2, ECR_RUN};
+static I2C_Xfer_t PadInit = {&LeafyI2C, 0xB4, (void *)&txConfig, sizeof(txConfig), 1, 0, NULL, false, NULL, I2C_CONTROL};
+// New thresholds: stop, then registers 0x41..0x5E ending with the ECR
+static uint8_t txStop[2] = {0x5E, 0x00};
+static I2C_Xfer_t PadStop = {&LeafyI2C, 0xB4, txStop, 2, 1, 0, NULL, false, NULL, I2C_CONTROL};
+typedef struct {
+ uint8_t addr;
+ uint8_t thresholds[TOUCH_PADS][2];
+ uint8_t proxThresholds[2];
+ uint8_t debounce;
+ uint8_t afe1;
+ uint8_t afe2;
+ uint8_t ecr;
+} PadThresholds_t;
+static PadThresholds_t txThresholds = {0x41, THRESHOLDS, {0, 0},
+ TOUCH_DEBOUNCE << 4 | TOUCH_DEBOUNCE, AFE1, AFE2, ECR_RUN};
+static I2C_Xfer_t PadThresholds = {&LeafyI2C, 0xB4, (void *)&txThresholds, sizeof(txThresholds), 1, 0, NULL, false, NULL, I2C_CONTROL};
+// Raw data: filtered data 0x04..0x1D (with proximity), baseline 0x1E..0x29
+static uint8_t txRawAddr[1] = {0x04};
+static uint8_t rxRaw[38];
+static void CallbackRawRead(I2C_Xfer_t *p);
+static I2C_Xfer_t PadRawAddr = {&LeafyI2C, 0xB4, txRawAddr, 1, 0, 0, NULL, false, NULL, I2C_BULK};
+static I2C_Xfer_t PadRawData = {&LeafyI2C, 0xB5, rxRaw, sizeof(rxRaw), 1, 0, NULL, true, CallbackRawRead, I2C_BULK};
+static TouchRaw_t raw;
+static uint16_t calMin[TOUCH_PADS], calMax[TOUCH_PADS]; // Filtered data range while calibrating
+static volatile bool rawWanted = false;
+static volatile int calSamples = TOUCH_CAL_SAMPLES; // Reads still to take
+// I2C combined write-read transfer to read Touchpad sensor
+// Touch Status Registers (lower and upper)
+static uint8_t txRdAddr[1] = {0x00}; //{0x??}; // Register Address (lower)
+static uint8_t rxRdData[2]; // Read Data (2 bytes)
+static void CallbackTouchRead(I2C_Xfer_t *p);
+static I2C_Xfer_t PadRdAddr = {&LeafyI2C, 0xB4, txRdAddr, 1, 0, 0, NULL, false, NULL, I2C_INPUT};
+static I2C_Xfer_t PadRdData = {&LeafyI2C, 0xB5, rxRdData, 2, 1, 0, NULL, false, CallbackTouchRead, I2C_INPUT};
+// Status to be read: set at start, on failed reads and by the IRQ line
+static volatile bool touchChanged = true;
+static Time_t lastRead;
+#ifdef TOUCH_INT_PIN
+// Controller IRQ output, low from a touch status change until read
+static const Pin_t TouchInt = TOUCH_INT_PIN;
+static void CallbackTouchChanged (void) {
+ touchChanged = true;
+ ScanTouchpad(); // Read now rather than at the next scan
+}
+#endif
+// Enable Touchpad driver
+void TouchEnable (void) {
+ if (!enabled) {
+ enabled = true;
+ I2C_Enable(LeafyI2C);
+ I2C_Request(&PadReset);
+ I2C_Request(&PadInit);
+ for (int i = 0; i < TOUCH_PADS; i++) {
+ raw.touch[i] = TOUCH_THRESHOLD;
+ raw.release[i] = TOUCH_RELEASE;
+ }
+#ifdef TOUCH_INT_PIN
+ GPIO_Enable(TouchInt);
+ GPIO_Mode(TouchInt, INPUT);
+ GPIO_Config(TouchInt, PP, S0, PU); // Open-drain output on the controller
+ GPIO_Callback(TouchInt, CallbackTouchChanged, FALL);
+#endif
+ // First read on the next scan
+ lastRead = TimeNow();
+ TouchCalibrate();
+ }
+}
+static uint16_t touchData; // Pads held at the last read
+// Event ring of each page, written by the read callback
+static struct {
+ TouchEvent_t events[TOUCH_EVENTS];
+ volatile uint8_t head; // Next to write
+ volatile uint8_t tail; // Next to read
+} touchQueue[PAGES];
+static volatile uint32_t touchLost = 0;
+// Take the oldest event of a page
+bool TouchEvent (Page_t page, TouchEvent_t *e) {
+ uint8_t tail = touchQueue[page].tail;
+ if (tail == touchQueue[page].head)
+ return false;
+ *e = touchQueue[page].events[tail];
+ touchQueue[page].tail = (tail + 1) % TOUCH_EVENTS;
+ return true;
+}
+// --------------------------------------------------------
+// Gestures
+// --------------------------------------------------------
+// Gesture state of a page, advanced by the page's own calls
+typedef struct {
+ const TouchGestures_t *config;
+ TouchEvent_t next; // Event taken from the ring, not yet handled
+ bool hasNext;
+ uint16_t held; // Single pad held, 0 for none
+ Time_t pressTime;
+ bool longSent;
+ Time_t nextRepeat; // Hold time of the next repeat
+ Time_t period;
+ uint16_t repeats;
+ uint16_t lastTap; // Pad of the last press, a double tap candidate
+ Time_t tapTime;
+} GestureState_t;
+static GestureState_t gestures[PAGES];
+// Pad of a single pad bit, NONE for no pad or several
+static Press_t PadOf (uint16_t pads) {
+ for (Press_t n = MIN; n <= MAX; n++)
+ if (pads == 1 << n)
+ return n;
+ return NONE;
+}
+void TouchGestures (Page_t page, const TouchGestures_t *config) {
+ gestures[page].config = config;
+}
+// Next gesture of a page. Gestures timed by the hold come before a
+// queued event that happened later, so a release is never overtaken.
+bool TouchGesture (Page_t page, Gesture_t *g) {
+ static const TouchGestures_t off = {0};
+ GestureState_t *s = &gestures[page];
+ const TouchGestures_t *c = s->config != NULL ? s->config : &off;
+ for (;;) {
+ if (!s->hasNext)
+ s->hasNext = TouchEvent(page, &s->next);
+ Time_t now = s->hasNext ? s->next.time : TimeNow();
+ if (s->held) {
+ Time_t held = now - s->pressTime;
+ bool repeat = c->repeatDelay && (s->held & c->repeatPads) && held >= s->nextRepeat;
+ if (c->longPress && !s->longSent && held >= c->longPress
+ && !(repeat && s->nextRepeat < c->longPress)) {
+ s->longSent = true;
+ s->lastTap = 0; // A long press is no tap
+ *g = (Gesture_t){TOUCH_LONG, PadOf(s->held), s->pressTime + c->longPress, 0};
+ return true;
+ }
+ if (repeat) {
+ *g = (Gesture_t){TOUCH_REPEAT, PadOf(s->held), s->pressTime + s->nextRepeat, ++s->repeats};
+ // A page not polled for a period or more drops the missed repeats
+ // and restarts the period from now instead of catching up
+ if (held - s->nextRepeat >= s->period)
+ s->nextRepeat = held;
+ s->nextRepeat += s->period;
+ Time_t shorter = s->period - s->period * c->repeatAccel / 100;
+ s->period = shorter > c->repeatMin ? shorter : c->repeatMin;
+ return true;
+ }
+ }
+ if (!s->hasNext)
+ return false;
+ s->hasNext = false;
+ const TouchEvent_t *e = &s->next;
+ if (e->released & s->held)
+ s->held = 0;
+ Press_t pad = PadOf(e->pressed);
+ if (pad == NONE)
+ continue; // Release or chord
+ // New press, also while another pad is held
+ bool twice = c->doubleTap && e->pressed == s->lastTap && e->time - s->tapTime <= c->doubleTap;
+ s->held = e->pressed;
+ s->pressTime = e->time;
+ s->longSent = false;
+ s->nextRepeat = c->repeatDelay;
+ s->period = c->repeatPeriod;
+ s->repeats = 0;
+ s->lastTap = twice ? 0 : e->pressed;
+ s->tapTime = e->time;
+ *g = (Gesture_t){twice ? TOUCH_DOUBLE : TOUCH_PRESS, pad, e->time, 0};
+ return true;
+ }
+}
+// Single pad press: the next press, double tap or repeat of the page
+Press_t TouchInput (Page_t page) {
+ Gesture_t g;
+ while (TouchGesture(page, &g))
+ if (g.type != TOUCH_LONG)
+ return g.pad;
+ return NONE;
+}
+// Ongoing numeric entry
+bool TouchEntry(Page_t page, Entry_t *num) {
+ Gesture_t g;
+ while (TouchGesture(page, &g)) {
+ if (g.type == TOUCH_LONG) {
+ if (g.pad == SHIFT)
+ *num = 0; // Hold SHIFT to clear the entry
+ }
+ else if (g.pad >= N0 && g.pad <= N9)
+ *num = *num * 10 + g.pad; // Add new digit
+ else if (g.pad == SHIFT)
+ *num /= 10; // Erase last digit
+ else if (g.pad == NEXT)
+ return true; // Entry complete, later presses stay queued
+ }
+ return false;
+}
+uint16_t TouchPads (void) {
+ return touchData;
+}
+uint32_t TouchLost (void) {
+ return touchLost;
+}
+// Read complete: queue the change for the open page
+static void CallbackTouchRead (I2C_Xfer_t *p) {
+ if (p->status != I2C_OK) {
+ // Failed read, data is stale: try again on the next scan
+ touchChanged = true;
+ return;
+ }
+ uint16_t pads = (rxRdData[0] | rxRdData[1] << 8) & ((1 << (MAX+1)) - 1);
+ if (pads == touchData)
+ return;
+ TouchEvent_t e = {TimeNow(), pads, pads & ~touchData, touchData & ~pads};
+ touchData = pads;
+ Page_t page = GetPage();
+ uint8_t head = touchQueue[page].head, next = (head + 1) % TOUCH_EVENTS;
+ if (next == touchQueue[page].tail) {
+ touchLost++; // Ring full, keep the older events
+ return;
+ }
+ touchQueue[page].events[head] = e;
+ touchQueue[page].head = next;
+}
+// Called from main loop housekeeping: read the touch status every
+// TOUCH_POLL_MS, or when the controller signals a change
+void ScanTouchpad (void) {
+ if (!enabled)
+ return;
+ bool read = touchChanged || TimePassed(lastRead) >= TOUCH_POLL_MS;
+#ifdef TOUCH_INT_PIN
+ // The line stays low until read, also covers an edge missed at start
+ read = read || GPIO_Input(TouchInt) == LOW;
+#endif
+ if (read && !PadRdAddr.busy && !PadRdData.busy) {
+ touchChanged = false;
+ lastRead = TimeNow();
+ I2C_RequestRead(&PadRdAddr, &PadRdData);
+ }
+ // Raw reads for calibration or diagnostics, one per scan
+ if ((rawWanted || calSamples < TOUCH_CAL_SAMPLES) && !PadRawAddr.busy && !PadRawData.busy
+ && !PadThresholds.busy) {
+ rawWanted = false;
+ I2C_RequestRead(&PadRawAddr, &PadRawData);
+ }
+}
+// --------------------------------------------------------
+// Calibration and raw data
+// --------------------------------------------------------
+// Start a calibration: the thresholds follow from the noise of the
+// next TOUCH_CAL_SAMPLES raw reads with no pad touched
+void TouchCalibrate (void) {
+ for (int i = 0; i < TOUCH_PADS; i++) {
+ raw.noise[i] = 0;
+ calMin[i] = 0x3FF;
+ calMax[i] = 0;
+ }
+ calSamples = 0;
+}
+bool TouchCalibrating (void) {
+ return calSamples < TOUCH_CAL_SAMPLES;
+}
+void TouchSample (void) {
+ rawWanted = true;
+}
+const TouchRaw_t *TouchRaw (void) {
+ return &raw;
+}
+// Thresholds clear of the noise: touch at twice the noise plus the
+// default, release at half of that but not below the default
+static void SetThresholds (void) {
+ for (int i = 0; i < TOUCH_PADS; i++) {
+ int touch = 2 * raw.noise[i] + TOUCH_THRESHOLD;
+ raw.touch[i] = touch > 255 ? 255 : touch;
+ raw.release[i] = raw.touch[i] / 2 > TOUCH_RELEASE ? raw.touch[i] / 2 : TOUCH_RELEASE;
+ txThresholds.thresholds[i][0] = raw.touch[i];
+ txThresholds.thresholds[i][1] = raw.release[i];
+ }
+ // Registers only accept writes in stop mode
+ I2C_Request(&PadStop);
+ I2C_Request(&PadThresholds);
+}
+static void CallbackRawRead (I2C_Xfer_t *p) {
+ if (p->status != I2C_OK)
+ return; // Taken again on the next scan while calibrating
+ raw.time = TimeNow();
+ for (int i = 0; i < TOUCH_PADS; i++) {
+ raw.filtered[i] = (rxRaw[2*i] | rxRaw[2*i+1] << 8) & 0x3FF;
+ raw.baseline[i] = rxRaw[26+i] << 2;
+ }
+ if (calSamples >= TOUCH_CAL_SAMPLES)
+ return;
+ if (touchData != 0) {
+ TouchCalibrate(); // Touched: start over
+ return;
+ }
+ for (int i = 0; i < TOUCH_PADS; i++) {
+ if (raw.filtered[i] < calMin[i])
+ calMin[i] = raw.filtered[i];
+ if (raw.filtered[i] > calMax[i])
+ calMax[i] = raw.filtered[i];
+ raw.noise[i] = calMax[i] - calMin[i];
+ }
+ if (++calSamples == TOUCH_CAL_SAMPLES)
+ SetThresholds();
+}
+// Discard all queued events
+void ClearTouchpad (void) {
+ for (int i = 0; i < PAGES; i++) {
+ touchQueue[i].tail = touchQueue[i].head;
+ gestures[i].hasNext = false;
+ gestures[i].held = 0;
+ }
+}
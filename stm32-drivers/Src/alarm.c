@@ -63,6 +63,10 @@ static int motionFlag;
 
 static int shortPress;
 
+// Red, blue, green LED and buzzer levels of each state
+static PinGroup_t allOff, armedBlue, armedGreen, triggered;
+static bool blinkGreen;
+
 
 
 
@@ -107,13 +111,12 @@ void Init_Alarm (void) {
 
 
 
-    GPIO_Output(RedLED, LOW);
-
-    GPIO_Output(BlueLED, LOW);
-
-    GPIO_Output(GreenLED, LOW);
-
-    GPIO_Output(Buzzer, LOW);
+    const Pin_t outputs[] = {RedLED, BlueLED, GreenLED, Buzzer};
+    allOff = GPIO_Group(outputs, 4, 0b0000);
+    armedBlue = GPIO_Group(outputs, 4, 0b0010);
+    armedGreen = GPIO_Group(outputs, 4, 0b0100);
+    triggered = GPIO_Group(outputs, 4, 0b0001);
+    GPIO_GroupWrite(&allOff);
 
 
 
@@ -171,13 +174,7 @@ void Task_Alarm (void) {
 
 
 
-   GPIO_Output(RedLED, LOW);
-
-   GPIO_Output(BlueLED, LOW);
-
-   GPIO_Output(GreenLED, LOW);
-
-   GPIO_Output(Buzzer, LOW);
+   GPIO_GroupWrite(&allOff);
 
    DisplayEnable();
    DisplayColor(ALARM, WHITE);
@@ -193,14 +190,8 @@ void Task_Alarm (void) {
 
          printf("Armed at time %u", TimeNow());
 
-        GPIO_Output(RedLED, LOW);
-
-        GPIO_Output(Buzzer, LOW);
-
-
-       GPIO_Output(BlueLED, HIGH);
-
-       GPIO_Output(GreenLED, LOW);
+        GPIO_GroupWrite(&armedBlue);
+        blinkGreen = false;
 
        lastToggle = TimeNow();
 
@@ -229,13 +220,7 @@ void Task_Alarm (void) {
 
          printf("Disarmed at time %u", TimeNow());
 
-         GPIO_Output(RedLED, LOW);
-
-         GPIO_Output(BlueLED, LOW);
-
-         GPIO_Output(GreenLED, LOW);
-
-         GPIO_Output(Buzzer, LOW);
+         GPIO_GroupWrite(&allOff);
 
      }
 
@@ -249,18 +234,15 @@ void Task_Alarm (void) {
 
          printf("Alarm Triggered at time %u", TimeNow());
 
-         GPIO_Output(BlueLED, LOW);
-
-        GPIO_Output(GreenLED, LOW);
+         GPIO_GroupWrite(&triggered);
      }
 
      else if(TimePassed(lastToggle) >= LED_ON_TIME){
 
 
 
-       GPIO_Toggle(BlueLED);
-
-       GPIO_Toggle(GreenLED);
+       blinkGreen = !blinkGreen; // Blue and green alternate
+       GPIO_GroupWrite(blinkGreen ? &armedGreen : &armedBlue);
 
        lastToggle = TimeNow();
 
@@ -278,11 +260,7 @@ void Task_Alarm (void) {
 
     case TRIGGERED:
 
-    GPIO_Output(RedLED, HIGH);
-
-    GPIO_Output(BlueLED, LOW);
-
-    GPIO_Output(GreenLED, LOW);
+    GPIO_GroupWrite(&triggered);
 
     DisplayEnable();
     DisplayColor(ALARM, RED);
@@ -299,14 +277,8 @@ void Task_Alarm (void) {
 
          printf("Armed at time %u", TimeNow());
 
-         GPIO_Output(RedLED, LOW);
-
-         GPIO_Output(Buzzer, LOW);
-
-
-          GPIO_Output(BlueLED, HIGH);
-
-          GPIO_Output(GreenLED, LOW);
+         GPIO_GroupWrite(&armedBlue);
+         blinkGreen = false;
 
           lastToggle = TimeNow();
 
@@ -320,13 +292,7 @@ void Task_Alarm (void) {
 
           printf("Disarmed at time %u", TimeNow());
 
-          GPIO_Output(RedLED, LOW);
-
-          GPIO_Output(BlueLED, LOW);
-
-          GPIO_Output(GreenLED, LOW);
-
-          GPIO_Output(Buzzer, LOW);
+          GPIO_GroupWrite(&allOff);
 
 
      }
@@ -0,0 +1,323 @@
+// Display driver version 3
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include "display.h"
+#include "i2c.h"
+#include "systick.h"
+#ifndef NDISPLAY
+bool enabled = false; // Initialization complete
+Page_t openPage = 0; // Currently displayed page
+static const Pin_t TouchEn = {GPIOB, 5}; // Pin PB5 <- Touch En button
+Time_t pressTime; // Timestamp of last button press
+#define DEBOUNCE_TIME 50 // 50ms debounce
+static void CallbackTouchEnPress(void);
+static void CallbackTouchEnRelease(void);
+// --------------------------------------------------------
+// Display controller
+// --------------------------------------------------------
+#define ROWS 2 // Number of rows
+#define COLS 16 // Number of columns
+uint8_t dispText[PAGES][ROWS][COLS+1];
+// Command word
+typedef struct {
+ uint8_t ctrl; // Control byte
+uint8_t data; // Data byte
+} DispCmd_t;
+// Initialization command sequence
+static const DispCmd_t txInit[] = {
+ {0x80, 0x28}, // Function Set: 2-line, display OFF
+ {0x80, 0x0C}, // Display Control: display ON, cursor OFF, blink OFF
+ {0x80, 0x01}, // Display Clear
+ {0x80, 0x06} // Entry Mode Set: increment, no shift
+};
+// Display line
+typedef struct {
+ DispCmd_t cmd; // Command word to set display line
+ uint8_t ctrl; // Last control byte, data bytes to follow
+ uint8_t text[COLS]; // ASCII text to write to display
+} DispLine_t;
+#define LINE_HEADER 3 // Bytes ahead of the text
+// Select display line and print text
+static DispLine_t txLine[ROWS] = {
+ { {0x80, 0x80}, 0x40, {0} },
+ { {0x80, 0xC0}, 0x40, {0} } };
+static const uint8_t lineAddr[ROWS] = {0x80, 0xC0}; // Set DDRAM address commands
+static bool updateLine[2] = {false, false};
+// Shadow of the text on the glass, blank after the clear command
+static uint8_t glass[ROWS][COLS];
+static void CallbackLineSent(I2C_Xfer_t *p);
+// I2C transfers (by DMA)
+static I2C_Xfer_t DispInit = {&LeafyI2C, 0x7C, (uint8_t *)&txInit, 8, 1, 0, NULL, true};
+static I2C_Xfer_t DispLine[ROWS] = {
+ {&LeafyI2C, 0x7C, (uint8_t *)&txLine[0], 19, 1, 0, NULL, true, CallbackLineSent},
+ {&LeafyI2C, 0x7C, (uint8_t *)&txLine[1], 19, 1, 0, NULL, true, CallbackLineSent} };
+// Enable LCD display
+void DisplayEnable (void) {
+ if (!enabled) {
+ enabled = true;
+ I2C_Enable(LeafyI2C);
+ I2C_Request(&DispInit);
+ // Blank out display text on all pages/rows
+ for (int i = 0; i < PAGES ; i++)
+ for (int j = 0; j < ROWS; j++)
+ for (int k = 0; k < COLS ; k++)
+ dispText[i][j][k] = ' ';
+ for (int j = 0; j < ROWS; j++)
+ for (int k = 0; k < COLS ; k++)
+ glass[j][k] = ' ';
+ // Use the Touch En button to cycle between display pages
+ GPIO_Enable(TouchEn);
+ GPIO_Mode(TouchEn, INPUT);
+ GPIO_Callback(TouchEn, CallbackTouchEnPress, RISE);
+ GPIO_Callback(TouchEn, CallbackTouchEnRelease, FALL);
+ }
+}
+// --------------------------------------------------------
+// Text formatting
+// --------------------------------------------------------
+// Store a character if there is room
+static char *Put(char *p, const char *end, char c) {
+ if (p < end)
+ *p++ = c;
+ return p;
+}
+// Compact vsnprintf() for display lines: %d %i %u %x %X %c %s %%, flags
+// '-' and '0', width and precision (minimum digits, or string length).
+// With fixed set, %f takes an int holding the value times 10^precision:
+// "%5.1f" prints 215 as " 21.5", at most 14 fraction digits. Returns
+// the number of characters stored, or -1 at a conversion it does not
+// handle (float, long, more than 16 digits).
+int DisplayFormat(char *buf, int size, bool fixed, const char *fmt, va_list args) {
+ char *p = buf, *end = buf + size - 1;
+ for (; *fmt; fmt++) {
+ if (*fmt != '%') {
+ p = Put(p, end, *fmt);
+ continue;
+ }
+ // Flags, width and precision
+ bool left = false, zero = false;
+ for (fmt++; *fmt == '-' || *fmt == '0'; fmt++)
+ if (*fmt == '-')
+ left = true;
+ else
+ zero = true;
+ int width = 0, prec = -1;
+ for (; *fmt >= '0' && *fmt <= '9'; fmt++)
+ width = width*10 + *fmt - '0';
+ if (*fmt == '.')
+ for (fmt++, prec = 0; *fmt >= '0' && *fmt <= '9'; fmt++)
+ prec = prec*10 + *fmt - '0';
+ // Conversion, numbers are built backwards from the end of digits
+ char digits[16], *text = digits + sizeof(digits), sign = 0;
+ int len = 0;
+ switch (*fmt) {
+ case '%':
+ case 'c':
+ *--text = *fmt == '%' ? '%' : va_arg(args, int);
+ len = 1;
+ zero = false;
+ break;
+ case 's':
+ text = va_arg(args, char *);
+ while (text[len] && (prec < 0 || len < prec))
+ len++;
+ zero = false;
+ break;
+ case 'f':
+ if (!fixed)
+ return -1;
+ // fall through
+ case 'd': case 'i': case 'u': case 'x': case 'X': {
+ unsigned v, base = *fmt == 'x' || *fmt == 'X' ? 16 : 10;
+ const char *hex = *fmt == 'X' ? "0123456789ABCDEF" : "0123456789abcdef";
+ if (*fmt == 'u' || base == 16)
+ v = va_arg(args, unsigned);
+ else {
+ int i = va_arg(args, int);
+ v = i < 0 ? -(unsigned)i : (unsigned)i;
+ sign = i < 0 ? '-' : 0;
+ }
+ // Fixed point: prec fraction digits, a point and at least one more
+ int frac = *fmt == 'f' ? (prec < 0 ? 6 : prec) : 0;
+ int count = *fmt == 'f' ? frac + 1 : (prec < 0 ? 1 : prec);
+ // Digits and point must fit: longer integers go to vsnprintf(),
+ // which cannot take a fixed %f, so its fraction is cut instead
+ if (count + (frac != 0) > (int)sizeof(digits)) {
+ if (*fmt != 'f')
+ return -1;
+ frac = sizeof(digits) - 2;
+ count = frac + 1;
+ }
+ for (int k = 0; v || k < count; k++) {
+ if (frac && k == frac)
+ *--text = '.';
+ *--text = hex[v % base];
+ v /= base;
+ }
+ len = digits + sizeof(digits) - text;
+ break;
+ }
+ default:
+ return -1;
+ }
+ // Pad to width: spaces before the sign, zeros after it
+ int pad = width - len - (sign != 0);
+ if (!left && !zero)
+ for (; pad > 0; pad--)
+ p = Put(p, end, ' ');
+ if (sign)
+ p = Put(p, end, sign);
+ if (!left)
+ for (; pad > 0; pad--)
+ p = Put(p, end, '0');
+ for (int k = 0; k < len; k++)
+ p = Put(p, end, text[k]);
+ for (; pad > 0; pad--)
+ p = Put(p, end, ' ');
+ }
+ if (size > 0)
+ *p = '\0';
+ return p - buf;
+}
+// Format into a page line and space pad the remainder
+static void PrintLine(Page_t page, const int line, bool fixed, const char *msg, va_list args) {
+ char *text = (char *)dispText[page][line];
+ va_list copy;
+ va_copy(copy, args);
+ int chars = DisplayFormat(text, COLS+1, fixed, msg, copy);
+ va_end(copy);
+ // Conversions the compact formatter does not handle
+ if (chars < 0)
+ chars = vsnprintf(text, COLS+1, msg, args);
+ for (int i = chars; i < COLS; i++)
+ text[i] = ' ';
+ if (page == openPage)
+ updateLine[line] = true;
+}
+// Print a line of text with optional format specifiers
+void DisplayPrint (Page_t page, const int line, const char *msg, ...) {
+ va_list args;
+ va_start(args, msg);
+ PrintLine(page, line, false, msg, args);
+ va_end(args);
+}
+// Print a line with fixed-point %f: each %f takes an int scaled by
+// 10^precision, no float formatting is linked in
+void DisplayPrintFixed (Page_t page, const int line, const char *msg, ...) {
+ va_list args;
+ va_start(args, msg);
+ PrintLine(page, line, true, msg, args);
+ va_end(args);
+}
+// --------------------------------------------------------
+// Backlight controller
+// --------------------------------------------------------
+Color_t dispColor[PAGES] = {OFF, CYAN, MAGENTA, ORANGE};
+typedef struct {
+ uint8_t addr; // Address of the first register
+ uint8_t data[3]; // Red, green and blue, auto-incremented registers
+} BltCmd_t;
+// Transmit data buffer to set brightness of each LED
+static BltCmd_t txColor = {0x01, {0x00, 0x00, 0x00}};
+static bool updateBlt = true;
+static Color_t bltSent; // Color on the LEDs, valid once bltValid
+static bool bltValid = false;
+static void CallbackBltSent(I2C_Xfer_t *p);
+// I2C transfer, one burst for all three registers
+static I2C_Xfer_t BltColor = {&LeafyI2C, 0x5A, (void *)&txColor, 4, 1, 0, NULL, false, CallbackBltSent, I2C_CONTROL};
+// Set new backlight color
+void DisplayColor(const Page_t page, const Color_t color) {
+ dispColor[page] = color;
+ if (page == openPage)
+ updateBlt = true;
+}
+// Color not applied: send it again on the next update
+static void CallbackBltSent(I2C_Xfer_t *p) {
+ if (p->status != I2C_OK) {
+ bltValid = false;
+ updateBlt = true;
+ }
+}
+// --------------------------------------------------------
+// Automatic background updates
+// --------------------------------------------------------
+// Send the span of a display line that differs from the glass, from the
+// first to the last changed character. Nothing is sent if the glass
+// already shows the text.
+static void SendLine(int j) {
+ updateLine[j] = false;
+ const uint8_t *text = dispText[openPage][j];
+ int first = 0, last = COLS-1;
+ while (first < COLS && text[first] == glass[j][first])
+ first++;
+ if (first == COLS)
+ return;
+ while (text[last] == glass[j][last])
+ last--;
+ // Move the cursor to the first change, the controller increments it
+ txLine[j].cmd.data = lineAddr[j] + first;
+ for (int k = first; k <= last; k++)
+ txLine[j].text[k-first] = glass[j][k] = text[k];
+ DispLine[j].size = LINE_HEADER + last - first + 1;
+ I2C_Request(&DispLine[j]);
+}
+// Line not written to display: glass contents unknown, rewrite the
+// whole line on the next update. Text printed while the line was in
+// flight is sent by UpdateDisplay(), never copied in interrupt context
+// where PrintLine() may be halfway through the row.
+static void CallbackLineSent(I2C_Xfer_t *p) {
+ int j = p - DispLine;
+ if (p->status != I2C_OK) {
+ for (int k = 0; k < COLS; k++)
+ glass[j][k] = 0;
+ updateLine[j] = true;
+ }
+}
+// Called from main loop
+void UpdateDisplay(void) {
+ // Update display text once the line is no longer in flight
+ for (int j = 0; j < ROWS; j++)
+ if (!DispLine[j].busy && updateLine[j])
+ SendLine(j);
+ // Update backlight if the color differs from the LEDs
+ if (!BltColor.busy && updateBlt) {
+ updateBlt = false;
+ Color_t color = dispColor[openPage];
+ if (!bltValid || color != bltSent) {
+ bltSent = color;
+ bltValid = true;
+ // Extract individual color bytes
+ txColor.data[0] = (color >> 16) & 0xFF;
+ txColor.data[1] = (color >> 8) & 0xFF;
+ txColor.data[2] = (color >> 0) & 0xFF;
+ I2C_Request(&BltColor);
+ }
+ }
+}
+// --------------------------------------------------------
+// Page switching
+// --------------------------------------------------------
+// Obtain the currently displayed page
+Page_t GetPage (void) {
+ return openPage;
+}
+static void CallbackTouchEnPress (void) {
+ pressTime = TimeNow();
+}
+static void CallbackTouchEnRelease (void) {
+ Time_t heldTime = TimePassed(pressTime);
+ if (heldTime > DEBOUNCE_TIME) {
+ // Switch to next page
+ openPage++;
+ openPage %= PAGES;
+ // Force update of display text and backlight color
+ for (int i = 0; i < ROWS; i++)
+ updateLine[i] = true;
+ updateBlt = true;
+ // Touch input queued for the previous page stays with it
+ }
+}
+#endif // NDISPLAY
@@ -0,0 +1,387 @@
+// General-purpose input/output driver
+#include <stddef.h>
+#include  <stdbool.h>
+#include <stdio.h>
+#include "gpio.h"
+#include  "i2c.h"
+#include "profile.h"
+
+//Initialization
+
+// Enable the GPIO port peripheral clock for the specified pin
+void GPIO_Enable (Pin_t pin) {
+	GPIO_PortEnable(pin.port);
+
+}
+
+static void IOX_Enable(void);
+
+void GPIO_PortEnable  (GPIO_TypeDef *port) {
+	      if(  port   == GPIOX) {
+	    	    I2C_Enable(LeafyI2C);
+	    	    IOX_Enable();
+	      }
+	      else
+	    	  RCC->AHB2ENR |= RCC_AHB2ENR_GPIOAEN << GPIO_PORT_NUM(port);
+}
+
+void GPIO_Mode (Pin_t pin, PinMode_t mode) {
+	pin.port->MODER &= ~(0b11 << (2 * pin.bit));     // Clear mode bits
+	    pin.port->MODER |=  (mode  << (2 * pin.bit));    // Set new mode
+}
+
+void GPIO_Config (Pin_t pin, PinType_t ot, PinSpeed_t osp, PinPUPD_t pupd){  //set the pins electrical style
+	  GPIO_TypeDef *GPIOx = pin.port;
+	    uint32_t pos2 = (uint32_t)pin.bit * 2U;   // 2-bit fields per pin
+	    uint32_t bit1 = 1UL << pin.bit;       // musk
+
+	    // Output type (OTYPER): 0 = push-pull, 1 = open-drain
+	    if ((uint32_t)ot != 0U) {                      // assume enum: 0=PP, 1=OD
+	        GPIOx->OTYPER |= bit1;                      // set the pin (open drain)
+	    } else {
+	        GPIOx->OTYPER &= ~bit1;                    // clear the bit (push pull)
+	    }
+
+	    // Output speed (OSPEEDR): 2 bits per pin (00..11)
+	    GPIOx->OSPEEDR &= ~(0x3UL << pos2);                        // clear current setting
+	    GPIOx->OSPEEDR |=  ((uint32_t)osp & 0x3UL) << pos2;         // write new  speed
+
+	    // Pull-up / Pull-down (PUPDR): 2 bits per pin (00 none, 01 PU, 10 PD)
+	    GPIOx->PUPDR &= ~(0x3UL << pos2);                              // clear current setting
+	    GPIOx->PUPDR |=  ((uint32_t)pupd & 0x3UL) << pos2;             // write new resistor config
+
+}
+
+
+void GPIO_AltFunc(Pin_t pin, int af){  //  hook the pin up to a special prepheral inside the chip
+	GPIO_TypeDef *GPIOx = pin.port;
+	    uint32_t idx   = (pin.bit < 8U) ? 0U : 1U;           // AFRL for 0..7, AFRH for 8..15
+	    uint32_t shift = ((uint32_t)pin.bit & 0x7U) * 4U;    // 4 bits per pin
+
+	    GPIOx->AFR[idx] &= ~(0xFUL << shift);                            // clear the old AF
+	    GPIOx->AFR[idx] |=  ((uint32_t)af & 0xFU) << shift;              // WRITE THE NEW AF
+}
+
+// Pin observation and control
+
+// Observe the value of an input pin
+PinState_t GPIO_Input (const Pin_t pin) {
+	return (pin.port->IDR & (1 << pin.bit)) ? HIGH : LOW;
+}
+
+
+uint16_t    GPIO_PortInput  (GPIO_TypeDef *port){
+	return port ->IDR;
+}
+
+void GPIO_Output (Pin_t pin, const PinState_t state) {
+          if(pin.port  ==  GPIOX){
+        		if (state  ==  HIGH)
+        		        pin.port->ODR   |= 1 << pin.bit;        // Set pin
+        		    else
+        		        pin.port->ODR   &=  ~(1 << pin.bit); // Reset pin
+          }
+          else {
+        		if (state  ==  HIGH)
+        		        pin.port->BSRR = (1 << pin.bit);        // Set pin
+        		    else
+        		        pin.port->BSRR = (1 << (pin.bit + 16)); // Reset pin
+          }
+
+}
+
+
+void GPIO_PortOutput (GPIO_TypeDef *port, uint16_t states){
+	port -> ODR = states ;
+}
+
+void GPIO_Toggle (Pin_t pin) {
+	 pin.port->ODR ^=(1<<pin.bit);
+}
+
+// Precompute the BSRR words that drive each pin to its level in
+// `levels` (bit n for pins[n]), merging pins on the same port
+PinGroup_t GPIO_Group (const Pin_t *pins, int count, uint32_t levels) {
+	PinGroup_t group = {0};
+	for (int n = 0; n < count; n++) {
+		int i = 0;
+		while (i < group.ports && group.port[i] != pins[n].port)
+			i++;
+		if (i == GPIO_GROUP_PORTS)
+			continue; // Too many ports, pin left out
+		if (i == group.ports)
+			group.port[group.ports++] = pins[n].port;
+		if (levels & (1UL << n))
+			group.bsrr[i] |= 1UL << pins[n].bit;
+		else
+			group.bsrr[i] |= 1UL << (pins[n].bit + 16);
+	}
+	return group;
+}
+
+// Apply a group: one BSRR store per port, so the pins of a port change
+// together. The I/O expander has no BSRR, its pins change in one ODR
+// update and so go out in the same I2C frame.
+void GPIO_GroupWrite (const PinGroup_t *group) {
+	for (int i = 0; i < group->ports; i++) {
+		if (group->port[i] == GPIOX)
+			GPIOX->ODR = (GPIOX->ODR & ~(group->bsrr[i] >> 16)) | (group->bsrr[i] & 0xFFFF);
+		else
+			group->port[i]->BSRR = group->bsrr[i];
+	}
+}
+// Interrupt handling
+
+// Subscribers to each EXTI line and edge, taken from a fixed pool
+// Bits 0 to 15 (each can select one port GPIOA to GPIOH)
+// Rising and falling edge triggers for each
+typedef struct Subscriber_t {
+    GPIO_TypeDef *port;
+    void (*func) (void);
+    struct Subscriber_t *next;
+} Subscriber_t;
+static Subscriber_t pool[GPIO_SUBSCRIBERS];
+static Subscriber_t *freeList = NULL;
+static bool poolReady = false;
+static Subscriber_t *subscribers [16] [2];
+
+// Edge events, written by the EXTI handlers and read by ServiceGPIOEvents.
+// Single producer (all EXTI vectors share one priority, so they never
+// preempt each other) and single consumer (the task), so the ring needs
+// no locking: each side only writes its own index.
+static GPIO_Event_t events[GPIO_EVENTS];
+static volatile uint32_t eventHead = 0; // Next slot to write, ISR only
+static volatile uint32_t eventTail = 0; // Next slot to read, task only
+static GPIO_EventStats_t stats;
+
+// Register a function to be called when an interrupt occurs
+// The function runs in task context from ServiceGPIOEvents(). A line
+// can watch only one port at a time: false if another port already
+// uses it, or if the subscriber pool is exhausted.
+bool GPIO_Callback (Pin_t pin, void (*func) (void), PinEdge_t edge)
+{
+if (!poolReady) {
+for (int i = 0; i < GPIO_SUBSCRIBERS; i++) {
+pool[i].next = freeList;
+freeList = &pool[i];
+}
+poolReady = true;
+}
+uint32_t shift = 8*(pin.bit % 4);
+uint32_t port = GPIO_PORT_NUM(pin.port);
+bool inUse = subscribers[pin.bit][RISE] != NULL || subscribers[pin.bit][FALL] != NULL;
+if (freeList == NULL
+|| (inUse && ((EXTI->EXTICR[pin.bit / 4] >> shift) & 0xFF) != port))
+return false;
+
+Subscriber_t *s = freeList;
+freeList = s->next;
+s->port = pin.port;
+s->func = func;
+s->next = subscribers [pin.bit] [edge];
+subscribers [pin.bit] [edge] = s;
+
+// Enable interrupt generation
+if (edge == RISE)
+EXTI->RTSR1 |= 1 << pin.bit;
+else
+EXTI->FTSR1 |= 1 << pin.bit;
+// Select the port: clear the field first, it may hold a previous one
+EXTI->EXTICR[pin.bit / 4] = (EXTI->EXTICR[pin.bit / 4] & ~(0xFFUL << shift))
+| port << shift;
+EXTI->IMR1 |= 1 << pin.bit;
+
+// Enable interrupt vector
+NVIC->IPR[EXTI0_IRQn + pin.bit] = 0;
+__COMPILER_BARRIER();
+NVIC->ISER[ (EXTI0_IRQn + pin.bit) / 32] = 1 << ((EXTI0_IRQn + pin.bit) % 32);
+__COMPILER_BARRIER();
+return true;
+}
+
+// Unregister a function, the edge stops interrupting with its last one
+void GPIO_RemoveCallback (Pin_t pin, void (*func) (void), PinEdge_t edge)
+{
+for (Subscriber_t **p = &subscribers[pin.bit] [edge]; *p != NULL; p = &(*p)->next)
+if ((*p)->port == pin.port && (*p)->func == func) {
+Subscriber_t *s = *p;
+*p = s->next;
+s->next = freeList;
+freeList = s;
+break;
+}
+if (subscribers[pin.bit] [edge] == NULL) {
+if (edge == RISE)
+EXTI->RTSR1 &= ~(1 << pin.bit);
+else
+EXTI->FTSR1 &= ~(1 << pin.bit);
+}
+if (subscribers[pin.bit] [RISE] == NULL && subscribers[pin.bit] [FALL] == NULL)
+EXTI->IMR1 &= ~(1 << pin.bit);
+}
+
+// Queue an edge event, or count it lost when the ring is full
+static void PutEvent (int i, PinEdge_t edge, uint32_t time) {
+uint32_t head = eventHead;
+if (head - eventTail >= GPIO_EVENTS) {
+stats.overflows[i]++;
+return;
+}
+GPIO_Event_t *e = &events[head % GPIO_EVENTS];
+e->time = time;
+e->port = (EXTI->EXTICR[i / 4] >> 8*(i % 4)) & 0xFF;
+e->bit = i;
+e->edge = edge;
+__DMB(); // Event is complete before the task can see it
+eventHead = head + 1;
+if (head + 1 - eventTail > stats.maxDepth)
+stats.maxDepth = head + 1 - eventTail;
+}
+
+// Interrupt handler for all GPIO pins, every EXTI vector points here
+// Serves all pending lines at once, highest line first, so a burst on
+// several lines costs one exception. Only records the edges, callbacks
+// run later in task context.
+void GPIO_IRQHandler (void) {
+PROFILE_BEGIN(GPIO_IRQ);
+uint32_t time = TimeNowCycles();
+uint32_t rise = EXTI->RPR1 & 0xFFFF;
+uint32_t fall = EXTI->FPR1 & 0xFFFF;
+uint32_t lines = rise | fall;
+
+// Clear pending IRQs of the lines served here, so their vectors do not
+// run again for nothing (EXTI0 to EXTI15 are IRQs 11 to 26, one word)
+NVIC->ICPR[EXTI0_IRQn / 32] = lines << (EXTI0_IRQn % 32);
+if (rise)
+EXTI->RPR1 = rise; // Service interrupts
+if (fall)
+EXTI->FPR1 = fall;
+
+while (lines) {
+int i = 31 - __CLZ(lines);
+lines &= ~(1UL << i);
+// Both edges pending: their order is lost, rising is queued first
+if (rise & (1UL << i))
+PutEvent(i, RISE, time);
+if (fall & (1UL << i))
+PutEvent(i, FALL, time);
+}
+PROFILE_END(GPIO_IRQ);
+}
+
+// Take the oldest edge event, false if there is none
+bool GPIO_GetEvent (GPIO_Event_t *e) {
+uint32_t tail = eventTail;
+if (tail == eventHead)
+return false;
+*e = events[tail % GPIO_EVENTS];
+__DMB(); // Slot is read before the ISR may reuse it
+eventTail = tail + 1;
+return true;
+}
+
+const GPIO_EventStats_t *GPIO_EventStats (void) {
+return &stats;
+}
+
+// Called from main loop: run the callbacks of all queued edges in order
+void ServiceGPIOEvents (void) {
+GPIO_Event_t e;
+while (GPIO_GetEvent(&e)) {
+stats.events++;
+for (Subscriber_t *sub = subscribers[e.bit] [e.edge]; sub != NULL; ) {
+Subscriber_t *next = sub->next; // The callback may unregister itself
+if (GPIO_PORT_NUM(sub->port) == e.port)
+sub->func();
+sub = next;
+}
+}
+#ifdef DEBUG
+static uint32_t reported[16];
+for (int i = 0; i < 16; i++)
+if (stats.overflows[i] != reported[i]) {
+reported[i] = stats.overflows[i];
+printf("GPIO line %d: %lu edges lost\n", i, (unsigned long)reported[i]);
+}
+#endif
+}
+
+// All GPIO IRQs share the common handler
+#define EXTI_VECTOR(n) void EXTI##n##_IRQHandler(void) __attribute__((alias("GPIO_IRQHandler")));
+EXTI_VECTOR(0)  EXTI_VECTOR(1)  EXTI_VECTOR(2)  EXTI_VECTOR(3)
+EXTI_VECTOR(4)  EXTI_VECTOR(5)  EXTI_VECTOR(6)  EXTI_VECTOR(7)
+EXTI_VECTOR(8)  EXTI_VECTOR(9)  EXTI_VECTOR(10) EXTI_VECTOR(11)
+EXTI_VECTOR(12) EXTI_VECTOR(13) EXTI_VECTOR(14) EXTI_VECTOR(15)
+
+
+// Emulated GPIO registers for I/O expander
+GPIO_TypeDef IOX_GPIO_Regs = {0xFFFFFFFF, 0, 0, 0, 0, 0, 0, 0, {0, 0}, 0, 0, 0};
+// Transmit/receive data buffers
+
+static uint8_t IOX_txData = 0xFF;
+static uint8_t IOX_rxData = 0xFF;
+
+// Last LED byte sent, -1 before the first write
+static int IOX_sent = -1;
+// LEDs not written: send them again on the next update
+static void CallbackLEDsSent(I2C_Xfer_t *p) {
+	if (p->status != I2C_OK)
+		IOX_sent = -1;
+}
+
+// I2C transfer structures bus addr data size stop busy next
+
+static I2C_Xfer_t IOX_LEDs = {&LeafyI2C, 0x70, &IOX_txData, 1, 1, 0, NULL, false, CallbackLEDsSent, I2C_CONTROL};
+static I2C_Xfer_t IOX_PBs = {&LeafyI2C, 0x73, &IOX_rxData, 1, 1, 0, NULL, false, NULL, I2C_INPUT};
+
+#ifdef IOX_INT_PIN
+// Expander interrupt output, low while the buttons differ from the last read
+static const Pin_t IOX_Int = IOX_INT_PIN;
+static volatile bool IOX_changed = true;
+static void CallbackIOXChanged(void) {
+	IOX_changed = true;
+}
+#endif
+
+static Time_t IOX_lastPoll;
+
+// Set up the expander side once, however many of its pins are enabled
+static void IOX_Enable(void) {
+	static bool enabled = false;
+	if (enabled)
+		return;
+	enabled = true;
+#ifdef IOX_INT_PIN
+	GPIO_Enable(IOX_Int);
+	GPIO_Mode(IOX_Int, INPUT);
+	GPIO_Config(IOX_Int, PP, S0, PU); // Open-drain output on the expander
+	GPIO_Callback(IOX_Int, CallbackIOXChanged, FALL);
+#endif
+	IOX_lastPoll = TimeNow();
+}
+
+// Called from main loop: write the LEDs when they change, read the
+// buttons every IOX_POLL_MS or when the expander signals a change
+void UpdateIOExpanders(void) {
+	// Copy to/from data buffers, with polarity inversion
+	uint8_t leds = ~(GPIOX->ODR & 0xFF); // LEDs in bits 7:0
+	GPIOX->IDR = (~IOX_rxData) << 8; // PBs in bits 15:8
+
+	if (leds != IOX_sent && !IOX_LEDs.busy) {
+		IOX_txData = leds; // Buffer only changes between transfers
+		IOX_sent = leds;
+		I2C_Request(&IOX_LEDs);
+	}
+
+	bool poll = TimePassed(IOX_lastPoll) >= IOX_POLL_MS;
+#ifdef IOX_INT_PIN
+	poll = poll || IOX_changed;
+#endif
+	if (poll && !IOX_PBs.busy) {
+#ifdef IOX_INT_PIN
+		IOX_changed = false; // Reading clears the expander interrupt
+#endif
+		IOX_lastPoll = TimeNow();
+		I2C_Request(&IOX_PBs);
+	}
+}
@@ -0,0 +1,330 @@
+// I2C driver version 4 (interrupt-driven), one queue per controller
+#include <stddef.h>
+#include <stdio.h>
+#include "i2c.h"
+#include "gpio.h"
+#include "profile.h"
+#include "systick.h"
+// There is one I2C bus present on the lab platform:
+I2C_Bus_t LeafyI2C = {
+I2C2, // I2C controller 2
+{GPIOF, 0}, // SDA pin PF0
+{GPIOF, 1} // SCL pin PF1
+};
+// Queue state of each controller, so buses run independently: one
+// transfer queue per priority class and the transfer in progress
+typedef struct {
+I2C_TypeDef *iface;
+struct {
+I2C_Xfer_t *head;
+I2C_Xfer_t *tail;
+int skipped; // Transfers started while this class waited
+} queue[I2C_CLASSES];
+I2C_Xfer_t *current;
+int n; // Number of bytes transferred, -1 when idle
+Time_t started; // When the current transfer started
+} I2C_Queue_t;
+static I2C_Queue_t queues[] = {
+{I2C1, {{0}}, NULL, -1}, {I2C2, {{0}}, NULL, -1},
+{I2C3, {{0}}, NULL, -1}, {I2C4, {{0}}, NULL, -1} };
+#define I2C_QUEUES (sizeof(queues) / sizeof(queues[0]))
+#define I2C_QUEUE(i2c) (&queues[(i2c) == I2C1 ? 0 : (i2c) == I2C2 ? 1 : (i2c) == I2C3 ? 2 : 3])
+// Bit 0 of address byte indicates read vs write transfer
+#define I2C_READ(q) ((q)->addr & 0x1)
+#define I2C_WRITE(q) (!((q)->addr & 0x1))
+// Event and error interrupt vectors of each I2C controller
+#define I2C_EV_IRQN(i2c) ((i2c) == I2C1 ? I2C1_EV_IRQn : (i2c) == I2C2 ? I2C2_EV_IRQn : \
+(i2c) == I2C3 ? I2C3_EV_IRQn : I2C4_EV_IRQn)
+#define I2C_ER_IRQN(i2c) ((i2c) == I2C1 ? I2C1_ER_IRQn : (i2c) == I2C2 ? I2C2_ER_IRQn : \
+(i2c) == I2C3 ? I2C3_ER_IRQn : I2C4_ER_IRQn)
+// DMA channels for I2C2, routed by DMAMUX1 channel 0/1 to DMA1 channel 1/2
+// Refer to MCU Reference Manual, DMAMUX request table
+#define I2C_DMA_TX DMA1_Channel1
+#define I2C_DMA_RX DMA1_Channel2
+#define I2C2_DMAREQ_RX 19
+#define I2C2_DMAREQ_TX 20
+// DMA is only available on the controller that owns the channels
+#define I2C_DMA(q) ((q)->dma && (q)->bus->iface == I2C2)
+// Enable I2C controller and configure associated GPIO pins
+void I2C_Enable (I2C_Bus_t bus) {
+if (bus.iface->CR1 & I2C_CR1_PE)
+return; // Already enabled
+// Enable clock to selected I2C controller
+RCC->APB1ENR1 |= bus.iface == I2C1 ? RCC_APB1ENR1_I2C1EN :
+bus.iface == I2C2 ? RCC_APB1ENR1_I2C2EN :
+bus.iface == I2C3 ? RCC_APB1ENR1_I2C3EN : 0;
+RCC->APB1ENR2 |= bus.iface == I2C4 ? RCC_APB1ENR2_I2C4EN : 0;
+// Enable clocks to GPIO ports containing SDA and SCL pins
+GPIO_Enable(bus.pinSDA);
+GPIO_Enable(bus.pinSCL);
+// Configure for open drain (PMOS disabled)
+GPIO_Config(bus.pinSDA, OD, S0, NOPUPD);
+GPIO_Config(bus.pinSCL, OD, S0, NOPUPD);
+// Select alternate function as I2C
+GPIO_AltFunc(bus.pinSDA, 0x4);
+GPIO_AltFunc(bus.pinSCL, 0x4);
+// Alternate function mode
+GPIO_Mode(bus.pinSDA, ALTFUNC);
+GPIO_Mode(bus.pinSCL, ALTFUNC);
+// Configure I2C peripheral
+bus.iface->CR1 &= ~I2C_CR1_PE;
+bus.iface->TIMINGR = 0xB0420F13; //0xE14
+bus.iface->CR1 = I2C_CR1_PE
+| I2C_CR1_TXIE | I2C_CR1_RXIE // Byte transmit/receive
+| I2C_CR1_TCIE | I2C_CR1_STOPIE // End of transfer
+| I2C_CR1_NACKIE | I2C_CR1_ERRIE; // Errors
+// Connect DMA channels to the data registers
+if (bus.iface == I2C2) {
+RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN | RCC_AHB1ENR_DMAMUX1EN;
+DMAMUX1_Channel0->CCR = I2C2_DMAREQ_TX;
+DMAMUX1_Channel1->CCR = I2C2_DMAREQ_RX;
+I2C_DMA_TX->CPAR = (uint32_t)&bus.iface->TXDR;
+I2C_DMA_RX->CPAR = (uint32_t)&bus.iface->RXDR;
+}
+// Enable interrupt vectors
+int evIRQn = I2C_EV_IRQN(bus.iface);
+int erIRQn = I2C_ER_IRQN(bus.iface);
+NVIC->IPR[evIRQn] = 0;
+NVIC->IPR[erIRQn] = 0;
+__COMPILER_BARRIER();
+NVIC->ISER[evIRQn / 32] = 1 << (evIRQn % 32);
+NVIC->ISER[erIRQn / 32] = 1 << (erIRQn % 32);
+__COMPILER_BARRIER();
+}
+// Take the next transfer off the queues: the highest class with work,
+// unless a lower one has been passed over I2C_AGING times
+static I2C_Xfer_t *NextTransfer (I2C_Queue_t *b) {
+int pick = -1;
+for (int c = I2C_CLASSES - 1; c >= 0; c--)
+if (b->queue[c].head != NULL
+&& (pick == -1 || (b->queue[c].skipped >= I2C_AGING && b->queue[c].skipped >= b->queue[pick].skipped)))
+pick = c;
+if (pick == -1)
+return NULL;
+for (int c = 0; c < I2C_CLASSES; c++)
+if (b->queue[c].head != NULL && c != pick)
+b->queue[c].skipped++;
+b->queue[pick].skipped = 0;
+I2C_Xfer_t *q = b->queue[pick].head;
+b->queue[pick].head = q->next;
+q->next = NULL;
+return q;
+}
+// Begin the transfer taken off the queue
+static void StartTransfer (I2C_Queue_t *b, I2C_Xfer_t *q) {
+b->current = q;
+I2C_TypeDef *i2c = b->iface;
+b->n = 0;
+b->started = TimeNow();
+i2c->ICR = 0xFFFF; // Clear flags
+if (I2C_DMA(q)) {
+// Whole buffer is moved by DMA, only the end of transfer interrupts
+DMA_Channel_TypeDef *dma = I2C_READ(q) ? I2C_DMA_RX : I2C_DMA_TX;
+dma->CCR = 0;
+dma->CM0AR = (uint32_t)q->data;
+dma->CNDTR = q->size;
+dma->CCR = DMA_CCR_MINC | (I2C_READ(q) ? 0 : DMA_CCR_DIR) | DMA_CCR_EN;
+i2c->CR1 = (i2c->CR1 & ~(I2C_CR1_TXIE | I2C_CR1_RXIE))
+| (I2C_READ(q) ? I2C_CR1_RXDMAEN : I2C_CR1_TXDMAEN);
+b->n = q->size;
+}
+// A START after a transfer without STOP produces a repeated START
+i2c->CR2 = (q->addr & 0xFE)
+| I2C_READ(q) << I2C_CR2_RD_WRN_Pos
+| q->size << I2C_CR2_NBYTES_Pos
+| q->stop << I2C_CR2_AUTOEND_Pos
+| I2C_CR2_START;
+}
+// Retire the completed transfer and begin the next one
+static void FinishTransfer (I2C_Queue_t *b, I2C_Status_t status) {
+I2C_Xfer_t *q = b->current;
+if (q->status == I2C_OK)
+q->status = status; // Keep an earlier NACK
+if (I2C_DMA(q)) {
+// Return to per-byte interrupts
+I2C_DMA_TX->CCR = 0;
+I2C_DMA_RX->CCR = 0;
+b->iface->CR1 = (b->iface->CR1 & ~(I2C_CR1_TXDMAEN | I2C_CR1_RXDMAEN))
+| I2C_CR1_TXIE | I2C_CR1_RXIE;
+}
+b->current = NULL;
+q->busy = 0; // Mark transfer as complete
+b->n = -1; // Prepare for next transfer
+I2C_Xfer_t *next, *failed = NULL;
+if (!q->stop) {
+// The read queued with this write by I2C_RequestRead() is next in the
+// class, nothing can be queued between them
+next = b->queue[q->priority].head;
+if (next != NULL) {
+b->queue[q->priority].head = next->next;
+next->next = NULL;
+}
+if (q->status != I2C_OK) {
+// Write failed and the bus was released: fail the read too
+failed = next;
+next = NextTransfer(b);
+}
+}
+else
+next = NextTransfer(b);
+if (next != NULL)
+StartTransfer(b, next);
+else if (!q->stop && failed == NULL)
+b->iface->CR2 |= I2C_CR2_STOP; // Release bus held for a read
+// Notify the requesters last, so they may queue new transfers
+if (q->callback != NULL)
+q->callback(q);
+if (failed != NULL) {
+failed->status = q->status;
+failed->busy = 0;
+if (failed->callback != NULL)
+failed->callback(failed);
+}
+}
+// Add a transfer request to the queue of its bus, false if it is still
+// queued or in progress from an earlier request (queue left untouched)
+bool I2C_Request (I2C_Xfer_t *p) {
+I2C_Queue_t *b = I2C_QUEUE(p->bus->iface);
+// Queue is shared with the interrupt handler
+uint32_t primask = __get_PRIMASK();
+__disable_irq();
+if (p->busy) {
+__set_PRIMASK(primask);
+return false;
+}
+p->status = I2C_OK;
+p->next = NULL;
+p->busy = true; // Mark transfer as in-progress
+if (b->queue[p->priority].head == NULL)
+b->queue[p->priority].head = p; // Add to empty queue
+else
+b->queue[p->priority].tail->next = p; // Add to tail of non-empty queue
+b->queue[p->priority].tail = p;
+// Start right away if the controller is idle
+if (b->current == NULL && b->iface->CR1 & I2C_CR1_PE)
+StartTransfer(b, NextTransfer(b));
+__set_PRIMASK(primask);
+return true;
+}
+// Queue a write without STOP and the read that follows it with a
+// repeated START as one unit, so no other transfer of the class (an
+// interrupt callback's, say) can come in between. The read takes the
+// write's class. False if either is still busy (queue left untouched).
+bool I2C_RequestRead (I2C_Xfer_t *wr, I2C_Xfer_t *rd) {
+I2C_Queue_t *b = I2C_QUEUE(wr->bus->iface);
+uint32_t primask = __get_PRIMASK();
+__disable_irq();
+if (wr->busy || rd->busy) {
+__set_PRIMASK(primask);
+return false;
+}
+wr->status = rd->status = I2C_OK;
+wr->stop = false;
+rd->priority = wr->priority;
+wr->next = rd;
+rd->next = NULL;
+wr->busy = rd->busy = true;
+if (b->queue[wr->priority].head == NULL)
+b->queue[wr->priority].head = wr;
+else
+b->queue[wr->priority].tail->next = wr;
+b->queue[wr->priority].tail = rd;
+if (b->current == NULL && b->iface->CR1 & I2C_CR1_PE)
+StartTransfer(b, NextTransfer(b));
+__set_PRIMASK(primask);
+return true;
+}
+// Reset the controller and free the bus: a target that lost clocks in
+// the middle of a byte can hold SDA low, up to nine SCL pulses let it
+// finish the byte and release SDA
+static void RecoverBus (I2C_Bus_t *bus) {
+bus->iface->CR1 &= ~I2C_CR1_PE; // Software reset of the controller
+if (bus->iface == I2C2) {
+I2C_DMA_TX->CCR = 0;
+I2C_DMA_RX->CCR = 0;
+}
+bus->iface->CR1 = (bus->iface->CR1 & ~(I2C_CR1_TXDMAEN | I2C_CR1_RXDMAEN))
+| I2C_CR1_TXIE | I2C_CR1_RXIE;
+GPIO_Output(bus->pinSCL, HIGH);
+GPIO_Mode(bus->pinSCL, OUTPUT); // Open drain, as configured for I2C
+for (int i = 0; i < 9 && GPIO_Input(bus->pinSDA) == LOW; i++) {
+uint32_t t = TimeNowCycles();
+GPIO_Output(bus->pinSCL, LOW);
+while (TimeNowCycles() - t < 5 * CYCLES_PER_US);
+GPIO_Output(bus->pinSCL, HIGH);
+while (TimeNowCycles() - t < 10 * CYCLES_PER_US);
+}
+GPIO_Mode(bus->pinSCL, ALTFUNC);
+bus->iface->CR1 |= I2C_CR1_PE;
+}
+// Transfers are advanced by the interrupt handlers. Called from main
+// loop every tick to start requests queued before I2C_Enable and to
+// abort a transfer whose interrupts stopped (stuck target or bus)
+void ServiceI2CRequests (void) {
+for (unsigned i = 0; i < I2C_QUEUES; i++) {
+I2C_Queue_t *b = &queues[i];
+__disable_irq();
+if (b->current != NULL && b->n != -1 && TimePassed(b->started) >= I2C_TIMEOUT_MS) {
+RecoverBus(b->current->bus);
+FinishTransfer(b, I2C_TIMEOUT);
+}
+if (b->current == NULL && b->iface->CR1 & I2C_CR1_PE) {
+I2C_Xfer_t *q = NextTransfer(b);
+if (q != NULL)
+StartTransfer(b, q);
+}
+__enable_irq();
+}
+}
+// Event interrupt handler for all I2C controllers
+static void I2C_EV_IRQHandler (I2C_TypeDef *i2c) {
+PROFILE_BEGIN(I2C_EV_IRQ);
+I2C_Queue_t *b = I2C_QUEUE(i2c);
+I2C_Xfer_t *q = b->current;
+uint32_t isr = i2c->ISR;
+if (q == NULL) {
+i2c->ICR = 0xFFFF; // Nothing in progress on this controller
+PROFILE_END(I2C_EV_IRQ);
+return;
+}
+if (isr & I2C_ISR_TXIS && b->n < q->size)
+// Copy transmit data from memory buffer to hardware buffer
+i2c->TXDR = q->data[b->n++];
+if (isr & I2C_ISR_RXNE && b->n < q->size)
+// Copy receive data from hardware buffer to memory buffer
+q->data[b->n++] = i2c->RXDR;
+if (isr & I2C_ISR_NACKF) {
+// Not acknowledged, STOP is generated automatically
+i2c->ICR = I2C_ICR_NACKCF;
+q->status = I2C_NACK;
+}
+if (isr & I2C_ISR_STOPF) {
+// End of a transfer with AUTOEND, or after a NACK
+i2c->ICR = I2C_ICR_STOPCF;
+FinishTransfer(b, I2C_OK);
+}
+else if (isr & I2C_ISR_TC)
+// End of a transfer without STOP, bus is held until the next START
+FinishTransfer(b, I2C_OK);
+PROFILE_END(I2C_EV_IRQ);
+}
+// Error interrupt handler for all I2C controllers
+static void I2C_ER_IRQHandler (I2C_TypeDef *i2c) {
+// Bus error, arbitration lost or overrun: clear flags, reset the bus
+// and fail the transfer in progress so the queue keeps moving
+I2C_Queue_t *b = I2C_QUEUE(i2c);
+i2c->ICR = I2C_ICR_BERRCF | I2C_ICR_ARLOCF | I2C_ICR_OVRCF;
+if (b->current != NULL && b->n != -1) {
+RecoverBus(b->current->bus);
+FinishTransfer(b, I2C_BUS_ERROR);
+}
+}
+// Dispatch all I2C IRQs to common handler functions
+void I2C1_EV_IRQHandler() { I2C_EV_IRQHandler(I2C1); }
+void I2C1_ER_IRQHandler() { I2C_ER_IRQHandler(I2C1); }
+void I2C2_EV_IRQHandler() { I2C_EV_IRQHandler(I2C2); }
+void I2C2_ER_IRQHandler() { I2C_ER_IRQHandler(I2C2); }
+void I2C3_EV_IRQHandler() { I2C_EV_IRQHandler(I2C3); }
+void I2C3_ER_IRQHandler() { I2C_ER_IRQHandler(I2C3); }
+void I2C4_EV_IRQHandler() { I2C_EV_IRQHandler(I2C4); }
+void I2C4_ER_IRQHandler() { I2C_ER_IRQHandler(I2C4); }
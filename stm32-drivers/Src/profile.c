@@ -0,0 +1,49 @@
+// Code region profiling with the DWT cycle counter
+#include <stddef.h>
+#include <stdio.h>
+#include "profile.h"
+
+static Profile_t regions[PROFILE_REGIONS];
+static int nRegions = 0;
+
+// Add a sample to a region, claiming a table slot on first use
+void ProfileRecord (Profile_t **region, const char *name, uint32_t cycles) {
+    Profile_t *r = *region;
+    if (r == NULL) {
+        // Regions may first run in interrupt context
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if (nRegions < PROFILE_REGIONS) {
+            r = &regions[nRegions++];
+            r->name = name;
+            r->min = UINT32_MAX;
+            *region = r;
+        }
+        __set_PRIMASK(primask);
+        if (r == NULL)
+            return; // Table full, region is not recorded
+    }
+    r->count++;
+    r->total += cycles;
+    if (cycles < r->min)
+        r->min = cycles;
+    if (cycles > r->max)
+        r->max = cycles;
+}
+
+// Print min/mean/max cycles of every region, then start new statistics
+void ProfileDump (void) {
+    printf("%-16s %8s %6s %6s %6s\n", "region", "count", "min", "mean", "max");
+    for (int i = 0; i < nRegions; i++) {
+        Profile_t *r = &regions[i];
+        if (r->count == 0)
+            continue;
+        printf("%-16s %8lu %6lu %6lu %6lu\n", r->name, (unsigned long)r->count,
+               (unsigned long)r->min, (unsigned long)(r->total / r->count),
+               (unsigned long)r->max);
+        r->count = 0;
+        r->total = 0;
+        r->min = UINT32_MAX;
+        r->max = 0;
+    }
+}
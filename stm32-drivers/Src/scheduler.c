@@ -0,0 +1,87 @@
+// Cooperative scheduler with per-task period, phase and priority
+#include <stddef.h>
+#include <stdio.h>
+#include "scheduler.h"
+
+static Task_t *tasks = NULL;
+static int nTasks = 0;
+
+// CPU cycles spent in tasks since the last report
+static uint32_t busyCycles = 0;
+static uint32_t windowStart = 0;
+
+// Release time reached, allowing for rollover of the system time
+#define IS_DUE(t, now) ((int)((now) - (t)->due) >= 0)
+
+// Prepare the task table, called once before the main loop
+// Cycle counter must be running, see StartSysTick
+void StartScheduler (Task_t *table, int count) {
+    // Sort by priority so a single pass runs tasks in priority order
+    for (int i = 1; i < count; i++) {
+        Task_t t = table[i];
+        int j = i;
+        for (; j > 0 && table[j-1].priority > t.priority; j--)
+            table[j] = table[j-1];
+        table[j] = t;
+    }
+
+    Time_t now = TimeNow();
+    for (int i = 0; i < count; i++) {
+        table[i].due  = now + table[i].phase;
+        table[i].wcet = 0;
+        table[i].runs = 0;
+    }
+    tasks = table;
+    nTasks = count;
+    windowStart = TimeNowCycles();
+}
+
+// Called from main loop every tick
+void RunDueTasks (void) {
+    for (int i = 0; i < nTasks; i++) {
+        Task_t *t = &tasks[i];
+        Time_t now = TimeNow();
+        if (!IS_DUE(t, now))
+            continue; // Not released yet
+
+        uint32_t start = TimeNowCycles();
+        t->func();
+        uint32_t cycles = TimeNowCycles() - start;
+
+        busyCycles += cycles;
+        if (cycles > t->wcet)
+            t->wcet = cycles;
+        t->runs++;
+
+        // Keep the release grid, skipping releases that were missed
+        t->due += t->period;
+        if (IS_DUE(t, now))
+            t->due = now + t->period;
+    }
+}
+
+// Earliest release time over all tasks, for tickless idle
+Time_t NextDueTime (void) {
+    Time_t now = TimeNow();
+    Time_t next = now + TIME_MAX / 2;
+    for (int i = 0; i < nTasks; i++)
+        if ((int)(tasks[i].due - next) < 0)
+            next = tasks[i].due;
+    return next;
+}
+
+// Print worst-case execution times and CPU load since the last report
+void ReportTaskTimes (void) {
+    uint32_t window = TimeNowCycles() - windowStart;
+    for (int i = 0; i < nTasks; i++)
+        printf("%-8s %5lu ms %6lu us WCET %8lu runs\n", tasks[i].name,
+               (unsigned long)tasks[i].period,
+               (unsigned long)(tasks[i].wcet / CYCLES_PER_US),
+               (unsigned long)tasks[i].runs);
+    if (window > 0)
+        printf("CPU load %lu.%lu%%\n",
+               (unsigned long)(busyCycles * 100ULL / window),
+               (unsigned long)(busyCycles * 1000ULL / window % 10));
+    busyCycles = 0;
+    windowStart = TimeNowCycles();
+}
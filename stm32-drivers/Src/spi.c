@@ -0,0 +1,199 @@
+/*
+ * spi.c
+ *
+ *  Created on: Nov 20, 2025
+ *      Author: ashay020
+ */
+
+
+// SPI controller driver (interrupt/DMA-driven)
+#include <stddef.h>
+#include <stdio.h>
+#include "spi.h"
+#include "gpio.h"
+#include "systick.h"
+#include "profile.h"
+// SPI bus for the Environmental Sensor
+SPI_Bus_t EnvSPI = {
+ SPI1, // SPI controller 1
+ {GPIOA, 5}, // SCLK pin
+ {GPIOA, 6}, // MISO pin
+ {GPIOA, 7}, // MOSI pin
+ {GPIOD, 14} // NSS/CSB pin
+};
+// Queue state and DMA channels of each controller, so buses run
+// independently. DMAMUX1 channel k routes to DMA1 channel k+1.
+// Refer to MCU Reference Manual, DMAMUX request table
+typedef struct {
+ SPI_TypeDef *iface;
+ DMA_Channel_TypeDef *dmaRx; // Completion is signalled by this channel
+ DMA_Channel_TypeDef *dmaTx;
+ DMAMUX_Channel_TypeDef *muxRx;
+ DMAMUX_Channel_TypeDef *muxTx;
+ uint8_t reqRx, reqTx; // DMAMUX request lines
+ uint8_t chRx; // DMA1 channel number of dmaRx, for its flags
+ IRQn_Type irq;
+ SPI_Xfer_t *head; // Pointers to head and tail of the transfer queue
+ SPI_Xfer_t *tail;
+ int n; // 0 while a transfer is in progress, -1 when idle
+ Time_t started; // When the transfer in progress started
+} SPI_Queue_t;
+static SPI_Queue_t queues[] = {
+ {SPI1, DMA1_Channel3, DMA1_Channel4, DMAMUX1_Channel2, DMAMUX1_Channel3, 11, 12, 3, DMA1_Channel3_IRQn, NULL, NULL, -1},
+ {SPI2, DMA1_Channel5, DMA1_Channel6, DMAMUX1_Channel4, DMAMUX1_Channel5, 13, 14, 5, DMA1_Channel5_IRQn, NULL, NULL, -1},
+ {SPI3, DMA1_Channel7, DMA1_Channel8, DMAMUX1_Channel6, DMAMUX1_Channel7, 15, 16, 7, DMA1_Channel7_IRQn, NULL, NULL, -1} };
+#define SPI_QUEUES (sizeof(queues) / sizeof(queues[0]))
+#define SPI_QUEUE(spi) (&queues[(spi) == SPI1 ? 0 : (spi) == SPI2 ? 1 : 2])
+// Channel flags in DMA1 ISR/IFCR, four bits per channel
+#define DMA_FLAGS(b, flag) ((flag) << 4 * ((b)->chRx - 1))
+// Source and sink for the unused half of a one-way transfer
+static const uint8_t dummyTx = 0;
+static uint8_t dummyRx;
+// Enable SPI controller and configure associated GPIO pins
+void SPI_Enable (SPI_Bus_t bus) {
+ if (bus.iface->CR1 & SPI_CR1_SPE)
+ return; // Already enabled
+ // Enable clock to selected SPI controller
+ // See MCU Reference Manual, Table 82
+ RCC-> APB2ENR |= bus.iface == SPI1 ? RCC_APB2ENR_SPI1EN : 0;
+ RCC->APB1ENR1 |= bus.iface == SPI2 ? RCC_APB1ENR1_SPI2EN :
+ bus.iface == SPI3 ? RCC_APB1ENR1_SPI3EN : 0;
+ // Enable clocks to GPIO ports containing SPI pins
+ // ...
+ GPIO_Enable(bus.pinMISO); // for all of port A
+ GPIO_Enable(bus.pinMOSI);
+ GPIO_Enable(bus.pinSCLK);
+ GPIO_Enable(bus.pinNSS); // for port D
+
+
+// Alternate function mode (SCLK, MOSI, MISO only)
+GPIO_Mode(bus.pinMISO, ALTFUNC);
+GPIO_Mode(bus.pinSCLK, ALTFUNC);
+GPIO_Mode(bus.pinMOSI, ALTFUNC);
+
+// Select alternate function as SPI
+// See MCU Datasheet, Table 22
+ // ...
+ int af = bus.iface == SPI3 ? 6 : 5;
+ GPIO_AltFunc(bus.pinSCLK, af);
+ GPIO_AltFunc(bus.pinMOSI, af);
+ GPIO_AltFunc(bus.pinMISO, af);
+ // NSS: active low GP output, default inactive
+ // ...
+ GPIO_Mode(bus.pinNSS, OUTPUT);
+ GPIO_Output(bus.pinNSS, HIGH); // cause off is 1
+ // Configure SPI peripheral
+ bus.iface->CR1 &= ~SPI_CR1_SPE;
+ bus.iface->CR1 = SPI_CR1_MSTR | (5<<3) | SPI_CR1_SSM | SPI_CR1_SSI;
+ bus.iface->CR2 = SPI_CR2_FRXTH | (8 - 1) << SPI_CR2_DS_Pos;
+ bus.iface->CR1 |= SPI_CR1_SPE;
+ // Connect DMA channels to the data register
+ // Completion is signalled by the receive channel
+ SPI_Queue_t *b = SPI_QUEUE(bus.iface);
+ RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN | RCC_AHB1ENR_DMAMUX1EN;
+ b->muxRx->CCR = b->reqRx;
+ b->muxTx->CCR = b->reqTx;
+ b->dmaRx->CPAR = (uint32_t)&bus.iface->DR;
+ b->dmaTx->CPAR = (uint32_t)&bus.iface->DR;
+ NVIC->IPR[b->irq] = 0;
+ __COMPILER_BARRIER();
+ NVIC->ISER[b->irq / 32] = 1 << (b->irq % 32);
+ __COMPILER_BARRIER();
+}
+// Begin the transfer at the head of the queue
+static void StartTransfer (SPI_Queue_t *b) {
+ SPI_Xfer_t *p = b->head;
+ SPI_TypeDef *SPI = b->iface;
+ b->n = 0;
+ b->started = TimeNow();
+ GPIO_Output(p->bus->pinNSS, LOW); // Assert select
+ // Every transfer is full-duplex on the wire, the unused direction
+ // sends zeros or discards into a dummy byte
+ b->dmaRx->CCR = 0;
+ b->dmaRx->CM0AR = p->dir == TX ? (uint32_t)&dummyRx : (uint32_t)p->data;
+ b->dmaRx->CNDTR = p->size;
+ b->dmaRx->CCR = (p->dir == TX ? 0 : DMA_CCR_MINC)
+ | DMA_CCR_TCIE | DMA_CCR_TEIE | DMA_CCR_EN;
+ b->dmaTx->CCR = 0;
+ b->dmaTx->CM0AR = p->dir == RX ? (uint32_t)&dummyTx : (uint32_t)p->data;
+ b->dmaTx->CNDTR = p->size;
+ b->dmaTx->CCR = (p->dir == RX ? 0 : DMA_CCR_MINC)
+ | DMA_CCR_DIR | DMA_CCR_EN;
+ // Receive requests must be enabled before transmit starts the clock
+ SPI->CR2 |= SPI_CR2_RXDMAEN;
+ SPI->CR2 |= SPI_CR2_TXDMAEN;
+}
+// Remove the completed transfer from the queue and begin the next one
+static void FinishTransfer (SPI_Queue_t *b, SPI_Status_t status) {
+ SPI_Xfer_t *p = b->head;
+ p->status = status;
+ b->dmaRx->CCR = 0;
+ b->dmaTx->CCR = 0;
+ b->iface->CR2 &= ~(SPI_CR2_TXDMAEN | SPI_CR2_RXDMAEN);
+ if (p->last)
+ GPIO_Output(p->bus->pinNSS, HIGH); // De-assert select
+ b->head = p->next;
+ p->next = NULL;
+ p->latency = TimeNowCycles() - p->start;
+ p->busy = 0; // Mark transfer as complete
+ b->n = -1; // Prepare for next transfer
+ if (b->head != NULL)
+ StartTransfer(b);
+}
+// Add a transfer request to the queue of its bus, false if it is still
+// queued or in progress from an earlier request (queue left untouched)
+bool SPI_Request (SPI_Xfer_t *p) {
+ SPI_Queue_t *b = SPI_QUEUE(p->bus->iface);
+ // Queue is shared with the interrupt handler
+ uint32_t primask = __get_PRIMASK();
+ __disable_irq();
+ if (p->busy) {
+ __set_PRIMASK(primask);
+ return false;
+ }
+ p->status = SPI_OK;
+ p->next = NULL;
+ p->busy = true; // Mark transfer as in-progress
+ p->start = TimeNowCycles();
+ if (b->head == NULL)
+ b->head = p; // Add to empty queue
+ else
+ b->tail->next = p; // Add to tail of non-empty queue
+ b->tail = p;
+ // Start right away if the controller is idle
+ if (b->n == -1 && b->head == p && b->iface->CR1 & SPI_CR1_SPE)
+ StartTransfer(b);
+ __set_PRIMASK(primask);
+ return true;
+}
+// Transfers are advanced by the DMA interrupts. Called from main loop
+// to start requests queued before SPI_Enable and to abort a transfer
+// whose DMA never completed
+void ServiceSPIRequests (void) {
+ for (unsigned i = 0; i < SPI_QUEUES; i++) {
+ SPI_Queue_t *b = &queues[i];
+ __disable_irq();
+ if (b->head != NULL && b->n != -1 && TimePassed(b->started) >= SPI_TIMEOUT_MS) {
+ // Reset the controller, also flushes its FIFOs
+ b->iface->CR1 &= ~SPI_CR1_SPE;
+ b->iface->CR1 |= SPI_CR1_SPE;
+ FinishTransfer(b, SPI_TIMEOUT);
+ }
+ if (b->n == -1 && b->head != NULL && b->iface->CR1 & SPI_CR1_SPE)
+ StartTransfer(b);
+ __enable_irq();
+ }
+}
+// Receive DMA channel: all bytes of the transfer have been clocked
+static void SPI_DMA_IRQHandler (SPI_Queue_t *b) {
+ PROFILE_BEGIN(SPI_DMA_IRQ);
+ uint32_t isr = DMA1->ISR;
+ DMA1->IFCR = DMA_FLAGS(b, DMA_IFCR_CGIF1); // Clear channel flags
+ if (b->head != NULL && b->n != -1)
+ FinishTransfer(b, isr & DMA_FLAGS(b, DMA_ISR_TEIF1) ? SPI_DMA_ERROR : SPI_OK);
+ PROFILE_END(SPI_DMA_IRQ);
+}
+// Dispatch the receive channel IRQs of each controller
+void DMA1_Channel3_IRQHandler (void) { SPI_DMA_IRQHandler(&queues[0]); }
+void DMA1_Channel5_IRQHandler (void) { SPI_DMA_IRQHandler(&queues[1]); }
+void DMA1_Channel7_IRQHandler (void) { SPI_DMA_IRQHandler(&queues[2]); }
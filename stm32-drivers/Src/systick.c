@@ -0,0 +1,140 @@
+// Manage the system timer
+
+#include "systick.h"
+#include "sysclk.h"
+
+//#define SYSTICKS 4000 // 1ms with 4MHz clock
+#define SYSTICKS 48000
+//48000
+
+// SYSCLK_FREQ 48e6*0.001
+static volatile Time_t sysTime = 0;
+// Milliseconds counted by the next SysTick interrupt (tickless idle)
+static volatile Time_t tickStep = 1;
+// Longest sleep that fits the 24-bit reload register, in ms
+#define MAX_SLEEP ((SysTick_LOAD_RELOAD_Msk + 1) / SYSTICKS)
+// Upper word of the 64-bit cycle count, and the last value seen
+static volatile uint32_t cyclesHigh = 0;
+static volatile uint32_t cyclesLast = 0;
+static uint64_t TimeNowCycles64(void);
+
+void StartSysTick() {
+ConfigureSystemClock();
+sysTime = 0;
+// Enable the DWT cycle counter
+CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+DWT->CYCCNT = 0;
+DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+SysTick->LOAD = (uint32_t) (SYSTICKS - 1); // Set reload register value
+SCB->SHPR[12+SysTick_IRQn] = 7 << 5;  // Set interrupt priority
+SysTick->VAL = 0;
+SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk |
+				SysTick_CTRL_TICKINT_Msk  |
+				SysTick_CTRL_ENABLE_Msk;
+}
+// Interrupt handler
+void SysTick_Handler(void){
+TimeNowCycles64(); // Catch cycle counter wraps, at most 349ms apart
+sysTime += tickStep;
+tickStep = 1;
+if (SysTick->LOAD != SYSTICKS - 1) {
+// End of a stretched period, resume 1ms ticks
+SysTick->LOAD = SYSTICKS - 1;
+SysTick->VAL = 0;
+}
+}
+// Wait for system time to change
+void WaitForSysTick(void) {
+int wasTime = sysTime;
+while (sysTime == wasTime)
+// Instruction to keep CPU asleep until next interrupt
+__WFI();
+}
+// Sleep until a wakeup time or any interrupt, whichever comes first.
+// SysTick is stretched to fire at the wakeup time instead of every ms;
+// Stop modes are not used since they halt SysTick.
+void SleepUntil(Time_t wake) {
+Time_t ms = wake - sysTime;
+if ((int)ms <= 1) {
+WaitForSysTick(); // Due now or at the next tick
+return;
+}
+if (ms > MAX_SLEEP)
+ms = MAX_SLEEP;
+__disable_irq();
+if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+__enable_irq(); // Tick not counted yet, let the handler run first
+return;
+}
+// Stretch the current period to end at the wakeup time
+SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+uint32_t remain = SysTick->VAL; // Cycles to the next ms boundary
+SysTick->LOAD = remain + (ms - 1) * SYSTICKS - 1;
+SysTick->VAL = 0;
+tickStep = ms;
+SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+// Pending interrupts wake the core even with interrupts masked
+__WFI();
+SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+if (!(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)) {
+// Woken early: count the whole ms that passed and
+// resume 1ms ticks at the next ms boundary
+uint32_t elapsed = SysTick->LOAD - SysTick->VAL;
+uint32_t next = remain - elapsed;
+Time_t passed = 0;
+if (elapsed >= remain) {
+passed = 1 + (elapsed - remain) / SYSTICKS;
+next = SYSTICKS - (elapsed - remain) % SYSTICKS;
+}
+if (next < 2) {
+passed++; // Boundary is too close to program
+next += SYSTICKS;
+}
+sysTime += passed;
+tickStep = 1;
+SysTick->LOAD = next - 1;
+SysTick->VAL = 0;
+}
+SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+__enable_irq();
+}
+// Delay measured in milliseconds
+void msDelay(int t) {
+for (int i = 0; i < t; i++)
+WaitForSysTick ();
+
+}
+
+// Obtain the current system time
+Time_t TimeNow(void) {
+return sysTime;
+}
+// Calculate the elapsed system time since a previous event
+Time_t TimePassed(Time_t since) {
+Time_t now = sysTime;
+if (now >= since)
+return now - since;
+// Deal with rollover
+else
+return now + 1 + TIME_MAX - since;
+}
+// Obtain the CPU cycle count
+uint32_t TimeNowCycles(void) {
+return DWT->CYCCNT;
+}
+// Extend the cycle counter to 64 bits, called at least once per wrap
+static uint64_t TimeNowCycles64(void) {
+uint32_t primask = __get_PRIMASK();
+__disable_irq();
+uint32_t now = DWT->CYCCNT;
+if (now < cyclesLast)
+cyclesHigh++; // Counter wrapped since last call
+cyclesLast = now;
+uint64_t cycles = (uint64_t)cyclesHigh << 32 | now;
+__set_PRIMASK(primask);
+return cycles;
+}
+// Obtain the current time in microseconds, same rollover rules as TimeNow
+Time_t TimeNowUs(void) {
+return TimeNowCycles64() / CYCLES_PER_US;
+}
@@ -0,0 +1,7 @@
+# Shared driver library, included by the firmware build of every lab
+#   DRIVERS      path of this directory
+#   DRIVERS_SRCS sources, compiled once per image against that image's
+#                Inc/drivers_config.h
+#   DRIVERS_INC  include path of the driver headers
+DRIVERS_SRCS := $(wildcard $(DRIVERS)/Src/*.c)
+DRIVERS_INC := $(DRIVERS)/Inc
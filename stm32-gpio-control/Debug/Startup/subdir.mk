@@ -1,27 +0,0 @@
-################################################################################
-# Automatically-generated file. Do not edit!
-# Toolchain: GNU Tools for STM32 (13.3.rel1)
-################################################################################
-
-# Add inputs and outputs from these tool invocations to the build variables 
-S_SRCS += \
-../Startup/startup_stm32l552zetxq.s 
-
-OBJS += \
-./Startup/startup_stm32l552zetxq.o 
-
-S_DEPS += \
-./Startup/startup_stm32l552zetxq.d 
-
-
-# Each subdirectory must supply rules for building sources it contributes
-Startup/%.o: ../Startup/%.s Startup/subdir.mk
-	arm-none-eabi-gcc -mcpu=cortex-m33 -g3 -DDEBUG -c -I"C:/Users/bexne/Desktop/ceg3136_lab1 - Copy/Inc" -x assembler-with-cpp -MMD -MP -MF"$(@:%.o=%.d)" -MT"$@" --specs=nano.specs -mfpu=fpv5-sp-d16 -mfloat-abi=hard -mthumb -o "$@" "$<"
-
-clean: clean-Startup
-
-clean-Startup:
-	-$(RM) ./Startup/startup_stm32l552zetxq.d ./Startup/startup_stm32l552zetxq.o
-
-.PHONY: clean-Startup
-
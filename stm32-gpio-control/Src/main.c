@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include "gpio.h"
 #include "systick.h"
+#include "alarm.h"
 
 static const Pin_t BlueLED = {GPIOB, 7}; //Pin PB7 -> User LD2
 static const Pin_t Button = {GPIOB, 13}; //Pin PC13 <- User B1
@@ -21,6 +22,7 @@ int main (void){
 
 	while (1){
 		Task_Alarm();
+		ServiceGPIOEvents();
 		WaitForSysTick();
 	}
 
@@ -0,0 +1,631 @@
+// Benchmarks of the firmware in virtual time
+// Runs the unmodified firmware on the host simulator with a fixed input
+// script and reports latency percentiles and throughput:
+//   display   DisplayPrint() to the text on the glass
+//   touch     pad press to TouchInput() or TouchGesture() returning it
+//   enviro    period between sensor samples shown, SPI bytes per sample
+//   i2c, spi  request to completion of every bus transfer
+//   exti      pin edge to GPIO interrupt handler entry
+//   exti_isr  GPIO interrupt handler entry to return
+//   format    DisplayFormat() against vsnprintf(): host time per call and
+//             stack depth for the lines the apps print and a long precision
+// plus bus utilisation, core wakeups against a second run with 1 ms
+// ticks (fails if tickless idle does not reduce them) and the task table
+// statistics. The driver entry points are wrapped at link time (see the
+// bench target of the Makefile).
+//
+// Usage: bench [ms [file.csv]], 10 s by default. The CSV has one value
+// per line so runs of two commits can be compared with diff.
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "hostsim.h"
+#include "display.h"
+#include "touchpad.h"
+#include "i2c.h"
+#include "spi.h"
+#include "scheduler.h"
+#include "systick.h"
+
+#define COLS 16 // Display columns
+#define CYCLES_TO_US(c) ((double)(c) / (SIM_CPU_HZ / 1000000))
+
+void __real_DisplayPrint(Page_t page, const int line, const char *msg, ...);
+void __real_DisplayPrintFixed(Page_t page, const int line, const char *msg, ...);
+Press_t __real_TouchInput(Page_t page);
+bool __real_TouchGesture(Page_t page, Gesture_t *g);
+bool __real_I2C_Request(I2C_Xfer_t *p);
+bool __real_I2C_RequestRead(I2C_Xfer_t *wr, I2C_Xfer_t *rd);
+bool __real_SPI_Request(SPI_Xfer_t *p);
+void __real_StartScheduler(Task_t *table, int count);
+void __real_SleepUntil(Time_t wake);
+
+// --------------------------------------------------------
+// Latency samples
+// --------------------------------------------------------
+typedef struct {
+    const char *name;
+    SimTime_t *samples; // Cycles
+    size_t count;
+    size_t size;
+} Series_t;
+static Series_t display = {"display"}, touch = {"touch"}, enviro = {"enviro"},
+                i2c = {"i2c"}, spi = {"spi"}, exti = {"exti"}, extiIsr = {"exti_isr"};
+static Series_t *const series[] = {&display, &touch, &enviro, &i2c, &spi,
+                                   &exti, &extiIsr};
+#define SERIES (sizeof(series) / sizeof(series[0]))
+
+static void Sample(Series_t *s, SimTime_t cycles) {
+    if (s->count == s->size) {
+        s->size = s->size ? 2 * s->size : 1024;
+        s->samples = realloc(s->samples, s->size * sizeof(SimTime_t));
+        if (s->samples == NULL) {
+            perror("bench");
+            exit(EXIT_FAILURE);
+        }
+    }
+    s->samples[s->count++] = cycles;
+}
+static int Compare(const void *a, const void *b) {
+    SimTime_t x = *(const SimTime_t *)a, y = *(const SimTime_t *)b;
+    return x < y ? -1 : x > y;
+}
+// Nearest-rank percentile of sorted samples
+static SimTime_t Percentile(const Series_t *s, int pct) {
+    size_t rank = (s->count * pct + 99) / 100;
+    return s->samples[rank > 0 ? rank - 1 : 0];
+}
+
+// --------------------------------------------------------
+// Display: print to glass
+// --------------------------------------------------------
+// Oldest print of each row not yet on the glass, and the text it must show
+static struct {
+    bool pending;
+    Page_t page;
+    SimTime_t since;
+    char text[COLS + 1];
+} rows[2];
+static uint32_t lcdUpdates = 0;
+
+static void LcdChanged(int row) {
+    lcdUpdates++;
+    if (!rows[row].pending)
+        return;
+    if (rows[row].page != GetPage())
+        rows[row].pending = false; // Page switched, will never show
+    else if (strcmp(SimLcdRow(row), rows[row].text) == 0) {
+        Sample(&display, SimNow() - rows[row].since);
+        rows[row].pending = false;
+    }
+}
+static SimTime_t lastEnviro = 0;
+
+// Format as the driver does, space padded to the full row
+static void Format(char *text, bool fixed, const char *msg, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    int chars = DisplayFormat(text, COLS + 1, fixed, msg, copy);
+    va_end(copy);
+    if (chars < 0)
+        chars = vsnprintf(text, COLS + 1, msg, args);
+    for (int i = chars < 0 ? 0 : chars; i < COLS; i++)
+        text[i] = ' ';
+    text[COLS] = '\0';
+}
+static void Printed(Page_t page, const int line, const char *text) {
+    if (page == ENVIRO && line == 1) {
+        // Temperature is printed last of each sample
+        if (lastEnviro != 0)
+            Sample(&enviro, SimNow() - lastEnviro);
+        lastEnviro = SimNow();
+    }
+    if (page == GetPage() && line >= 0 && line < 2) {
+        if (rows[line].pending && rows[line].page != page)
+            rows[line].pending = false;
+        if (!rows[line].pending && strcmp(SimLcdRow(line), text) != 0) {
+            rows[line].pending = true;
+            rows[line].page = page;
+            rows[line].since = SimNow();
+        }
+        strcpy(rows[line].text, text);
+    }
+}
+void __wrap_DisplayPrint(Page_t page, const int line, const char *msg, ...) {
+    char text[COLS + 1];
+    va_list args;
+    va_start(args, msg);
+    Format(text, false, msg, args);
+    va_end(args);
+    Printed(page, line, text);
+    __real_DisplayPrint(page, line, "%s", text);
+}
+void __wrap_DisplayPrintFixed(Page_t page, const int line, const char *msg, ...) {
+    char text[COLS + 1];
+    va_list args;
+    va_start(args, msg);
+    Format(text, true, msg, args);
+    va_end(args);
+    Printed(page, line, text);
+    __real_DisplayPrintFixed(page, line, "%s", text);
+}
+
+// --------------------------------------------------------
+// Touch: pad press to TouchInput() or TouchGesture(). Calls inside
+// TouchPad.c are not wrapped, so each press is seen once.
+// --------------------------------------------------------
+static bool touchPending = false;
+static SimTime_t touchSince;
+static uint32_t touchPresses = 0, touchDelivered = 0;
+
+static void Delivered(void) {
+    touchDelivered++;
+    if (touchPending)
+        Sample(&touch, SimNow() - touchSince);
+    touchPending = false;
+}
+Press_t __wrap_TouchInput(Page_t page) {
+    Press_t pad = __real_TouchInput(page);
+    if (pad != NONE)
+        Delivered();
+    return pad;
+}
+bool __wrap_TouchGesture(Page_t page, Gesture_t *g) {
+    bool taken = __real_TouchGesture(page, g);
+    if (taken && (g->type == TOUCH_PRESS || g->type == TOUCH_DOUBLE))
+        Delivered();
+    return taken;
+}
+
+// --------------------------------------------------------
+// Bus transfers: request to completion
+// --------------------------------------------------------
+// Completion is seen at the first register access after the interrupt
+// handler clears the busy flag
+#define TRACKED 64
+static struct {
+    volatile bool *busy;
+    SimTime_t since;
+    Series_t *series;
+} tracked[TRACKED];
+static int trackedCount = 0;
+static uint32_t trackDropped = 0; // Transfers not timed, table full
+
+static void Track(volatile bool *busy, SimTime_t since, Series_t *s) {
+    if (trackedCount < TRACKED)
+        tracked[trackedCount++] = (typeof(tracked[0])){busy, since, s};
+    else
+        trackDropped++;
+}
+static void CheckTransfers(void) {
+    for (int i = 0; i < trackedCount; )
+        if (!*tracked[i].busy) {
+            Sample(tracked[i].series, SimNow() - tracked[i].since);
+            tracked[i] = tracked[--trackedCount];
+        }
+        else
+            i++;
+}
+bool __wrap_I2C_Request(I2C_Xfer_t *p) {
+    SimTime_t since = SimNow();
+    bool queued = __real_I2C_Request(p);
+    if (queued) // Refused while in flight: that transfer is timed already
+        Track(&p->busy, since, &i2c);
+    return queued;
+}
+bool __wrap_I2C_RequestRead(I2C_Xfer_t *wr, I2C_Xfer_t *rd) {
+    SimTime_t since = SimNow();
+    bool queued = __real_I2C_RequestRead(wr, rd);
+    if (queued) {
+        Track(&wr->busy, since, &i2c);
+        Track(&rd->busy, since, &i2c);
+    }
+    return queued;
+}
+bool __wrap_SPI_Request(SPI_Xfer_t *p) {
+    SimTime_t since = SimNow();
+    bool queued = __real_SPI_Request(p);
+    if (queued)
+        Track(&p->busy, since, &spi);
+    return queued;
+}
+
+// --------------------------------------------------------
+// GPIO interrupts: edge to handler, and handler cost
+// --------------------------------------------------------
+static void IrqReturned(IRQn_Type irq, SimTime_t raised, SimTime_t entry) {
+    if (irq < EXTI0_IRQn || irq > EXTI15_IRQn)
+        return;
+    Sample(&exti, entry - raised);
+    Sample(&extiIsr, SimNow() - entry);
+}
+
+// --------------------------------------------------------
+// Tasks
+// --------------------------------------------------------
+static Task_t *tasks;
+static int taskCount = 0;
+
+void __wrap_StartScheduler(Task_t *table, int count) {
+    tasks = table;
+    taskCount = count;
+    __real_StartScheduler(table, count);
+}
+
+// --------------------------------------------------------
+// Input script
+// --------------------------------------------------------
+// 0-1 s alarm page, 1-5 s calculator page with a NEXT press every
+// 200 ms, then the enviro page. Temperature steps every 250 ms. The
+// motor runs at half speed from 6 s, its encoder drives the EXTI.
+#define PAGE_HOLD SIM_MS(100) // Touch En button, above the debounce time
+#define TOUCH_START SIM_MS(1500)
+#define TOUCH_END SIM_MS(5000)
+#define TOUCH_PERIOD SIM_MS(200)
+#define TOUCH_HOLD SIM_MS(60)
+#define ENVIRO_STEP SIM_MS(250)
+#define MOTOR_START SIM_MS(6000)
+static const SimTime_t pageSwitches[] = {SIM_MS(1000), SIM_MS(5000)};
+
+static void PageButton(void *arg);
+static void TouchPress(void *arg);
+static void EnviroStep(void *arg);
+static void MotorStart(void *arg);
+static SimEvent_t pageEvent = {.fn = PageButton};
+static SimEvent_t touchEvent = {.fn = TouchPress};
+static SimEvent_t enviroEvent = {.fn = EnviroStep};
+static SimEvent_t motorEvent = {.fn = MotorStart};
+
+static void PageButton(void *arg) {
+    static int next = 0;
+    static bool pressed = false;
+    pressed = !pressed;
+    SimPin(GPIOB, 5, pressed);
+    if (pressed)
+        SimAt(&pageEvent, SimNow() + PAGE_HOLD);
+    else if (++next < (int)(sizeof(pageSwitches) / sizeof(pageSwitches[0])))
+        SimAt(&pageEvent, pageSwitches[next]);
+}
+static void TouchPress(void *arg) {
+    static bool pressed = false;
+    pressed = !pressed;
+    SimTouch(pressed ? 1 << NEXT : 0);
+    if (pressed) {
+        touchPresses++;
+        touchPending = true;
+        touchSince = SimNow();
+        SimAt(&touchEvent, SimNow() + TOUCH_HOLD);
+    }
+    else if (SimNow() + TOUCH_PERIOD - TOUCH_HOLD < TOUCH_END)
+        SimAt(&touchEvent, SimNow() + TOUCH_PERIOD - TOUCH_HOLD);
+}
+static void EnviroStep(void *arg) {
+    static int step = 0;
+    SimEnviro(20.0 + 0.1 * step++, 45.0);
+    SimAt(&enviroEvent, SimNow() + ENVIRO_STEP);
+}
+static void MotorStart(void *arg) {
+    SimPot(2048);
+}
+
+// --------------------------------------------------------
+// I2C bytes per 1 ms tick. The polled engine this replaced moved at
+// most one byte per SysTick, the interrupt engine is bounded by the
+// bus clock only.
+// --------------------------------------------------------
+static void I2CTick(void *arg);
+static SimEvent_t i2cTickEvent = {.fn = I2CTick};
+static uint32_t i2cTickPeak = 0, i2cTickBusy = 0; // Ticks moving any byte
+static uint32_t i2cTickBytes = 0; // Bytes in those ticks
+
+static void I2CTick(void *arg) {
+    static uint32_t last = 0;
+    uint32_t bytes = SimI2CStats.bytes - last;
+    last = SimI2CStats.bytes;
+    if (bytes != 0) {
+        i2cTickBusy++;
+        i2cTickBytes += bytes;
+    }
+    if (bytes > i2cTickPeak)
+        i2cTickPeak = bytes;
+    SimAt(&i2cTickEvent, SimNow() + SIM_MS(1));
+}
+
+// --------------------------------------------------------
+// Wakeups: tickless idle against 1 ms ticks. The bench runs itself a
+// second time with BENCH_TICKING set, where the main loop waits for
+// every SysTick as it did before tickless idle, and compares the
+// wakeups per second of the two runs.
+// --------------------------------------------------------
+static bool ticking = false;
+static const char *self, *runMs = "10000";
+
+void __wrap_SleepUntil(Time_t wake) {
+    if (ticking)
+        WaitForSysTick();
+    else
+        __real_SleepUntil(wake);
+}
+// Wakeups per second of the ticking run, negative if it failed
+static double TickingWakeups(void) {
+    int fd[2];
+    double rate = -1;
+    fflush(stdout);
+    if (pipe(fd) != 0)
+        return rate;
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Trap signals may be blocked here, the run needs them
+        sigset_t none;
+        sigemptyset(&none);
+        sigprocmask(SIG_SETMASK, &none, NULL);
+        dup2(fd[1], STDOUT_FILENO);
+        close(fd[0]);
+        close(fd[1]);
+        setenv("BENCH_TICKING", "1", 1);
+        execl(self, self, runMs, (char *)NULL);
+        _exit(EXIT_FAILURE);
+    }
+    close(fd[1]);
+    FILE *out = fdopen(fd[0], "r");
+    char line[256];
+    while (out != NULL && fgets(line, sizeof(line), out) != NULL)
+        sscanf(line, "ticking wakeups %lf", &rate);
+    if (out != NULL)
+        fclose(out);
+    if (pid > 0)
+        waitpid(pid, NULL, 0);
+    return rate;
+}
+
+// --------------------------------------------------------
+// Scenario and report
+// --------------------------------------------------------
+static const char *csvPath = NULL;
+
+void SimScenario(int argc, char **argv) {
+    if (argc > 1)
+        runMs = argv[1];
+    SimStopAt(SIM_MS(strtoul(runMs, NULL, 0)));
+    if (argc > 2)
+        csvPath = argv[2];
+    self = argv[0];
+    ticking = getenv("BENCH_TICKING") != NULL;
+    SimLcdChanged = LcdChanged;
+    SimAccessHook = CheckTransfers;
+    SimIrqHook = IrqReturned;
+    SimAt(&pageEvent, pageSwitches[0]);
+    SimAt(&touchEvent, TOUCH_START);
+    SimAt(&enviroEvent, 0);
+    SimAt(&motorEvent, MOTOR_START);
+    SimAt(&i2cTickEvent, SIM_MS(1));
+}
+
+// One line per value: metric,stat,value,unit
+static void CsvRow(FILE *csv, const char *metric, const char *stat,
+                   double value, const char *unit) {
+    if (csv != NULL)
+        fprintf(csv, "%s,%s,%.3f,%s\n", metric, stat, value, unit);
+}
+static void ReportBus(FILE *csv, const char *name, const SimBusStats_t *b,
+                      double seconds) {
+    double busy = 100.0 * b->busy / SimNow();
+    printf("%-8s %5.1f%% busy %8.0f transfers/s %8.0f bytes/s %u NACKs\n",
+           name, busy, b->transfers / seconds, b->bytes / seconds, b->nacks);
+    CsvRow(csv, name, "busy", busy, "%");
+    CsvRow(csv, name, "transfers", b->transfers / seconds, "1/s");
+    CsvRow(csv, name, "bytes", b->bytes / seconds, "B/s");
+    CsvRow(csv, name, "nacks", b->nacks, "count");
+}
+// --------------------------------------------------------
+// Formatter: DisplayFormat() against vsnprintf()
+// --------------------------------------------------------
+// Host figures: the time compares the two implementations, the stack
+// depth is of the host C library, not newlib-nano
+#define FORMAT_CALLS 200000
+#define STACK_PAINT 16384
+#define PAINT 0xA5
+
+static int Compact(char *buf, bool fixed, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int chars = DisplayFormat(buf, COLS + 1, fixed, fmt, args);
+    va_end(args);
+    // Falls back as the driver does
+    if (chars < 0) {
+        va_start(args, fmt);
+        chars = vsnprintf(buf, COLS + 1, fmt, args);
+        va_end(args);
+    }
+    return chars;
+}
+static int Libc(char *buf, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int chars = vsnprintf(buf, COLS + 1, fmt, args);
+    va_end(args);
+    return chars;
+}
+// Lines the apps print, each through both formatters
+static void EnviroLibc(char *b) { Libc(b, "Temp %3.1f'C", 21.5); }
+static void EnviroCompact(char *b) { Compact(b, true, "Temp %3.1f'C", 215); }
+static void MotorLibc(char *b) { Libc(b, "Ki:%1.3f %3d RPM", 0.03, 175); }
+static void MotorCompact(char *b) { Compact(b, true, "Ki:%1.3f %3d RPM", 30, 175); }
+static void GameLibc(char *b) { Libc(b, "Step %d/%d", 3, 12); }
+static void GameCompact(char *b) { Compact(b, false, "Step %d/%d", 3, 12); }
+static void CalcLibc(char *b) { Libc(b, "%u", 4000000000u); }
+static void CalcCompact(char *b) { Compact(b, false, "%u", 4000000000u); }
+// Precision beyond the digit buffer
+static void PrecLibc(char *b) { Libc(b, "%.20d", -42); }
+static void PrecCompact(char *b) { Compact(b, false, "%.20d", -42); }
+static const struct {
+    const char *name;
+    void (*libc)(char *buf);
+    void (*compact)(char *buf);
+} formats[] = {
+    {"enviro", EnviroLibc, EnviroCompact}, {"motor", MotorLibc, MotorCompact},
+    {"game", GameLibc, GameCompact}, {"calc", CalcLibc, CalcCompact},
+    {"prec", PrecLibc, PrecCompact}
+};
+
+// Deepest stack write of fn: paint the area below this frame, call fn
+// and find the lowest byte changed. Both helpers get the same frame.
+static __attribute__((noinline)) void StackPaint(void) {
+    volatile uint8_t area[STACK_PAINT];
+    for (size_t i = 0; i < sizeof(area); i++)
+        area[i] = PAINT;
+}
+// Reads what the previous calls left in the area on purpose
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+static __attribute__((noinline)) size_t StackDepth(void) {
+    volatile uint8_t area[STACK_PAINT];
+    size_t i = 0;
+    while (i < sizeof(area) && area[i] == PAINT)
+        i++;
+    return sizeof(area) - i;
+}
+#pragma GCC diagnostic pop
+static size_t StackOf(void (*fn)(char *buf)) {
+    char buf[COLS + 1];
+    StackPaint();
+    fn(buf);
+    return StackDepth();
+}
+static double NsPerCall(void (*fn)(char *buf)) {
+    char buf[COLS + 1];
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < FORMAT_CALLS; i++)
+        fn(buf);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / FORMAT_CALLS;
+}
+static void NoFormat(char *buf) {}
+
+static void ReportFormat(FILE *csv) {
+    printf("---- format (host) ----\n");
+    printf("%-8s %10s %10s %10s %10s\n", "", "libc ns", "ns", "libc stack", "stack");
+    size_t base = StackOf(NoFormat);
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        char libc[COLS + 1], compact[COLS + 1];
+        formats[i].libc(libc);
+        formats[i].compact(compact);
+        if (strcmp(libc, compact) != 0)
+            printf("%-8s mismatch: \"%s\" != \"%s\"\n", formats[i].name, compact, libc);
+        size_t libcStack = StackOf(formats[i].libc) - base;
+        size_t stack = StackOf(formats[i].compact) - base;
+        printf("%-8s %10.1f %10.1f %10zu %10zu\n", formats[i].name,
+               NsPerCall(formats[i].libc), NsPerCall(formats[i].compact),
+               libcStack, stack);
+        // Times vary between runs, only the stack goes to the CSV
+        CsvRow(csv, "format", formats[i].name, stack, "B");
+    }
+}
+
+void SimReport(void) {
+    double seconds = (double)SimNow() / SIM_CPU_HZ;
+    if (ticking) {
+        printf("ticking wakeups %.3f\n", SimWakeups / seconds);
+        return;
+    }
+    FILE *csv = NULL;
+    if (csvPath != NULL && (csv = fopen(csvPath, "w")) == NULL)
+        perror(csvPath);
+    if (csv != NULL)
+        fprintf(csv, "metric,stat,value,unit\n");
+    SimSummary();
+
+    printf("---- latency (us) ----\n");
+    printf("%-8s %7s %9s %9s %9s %9s %9s %9s\n",
+           "", "count", "min", "p50", "p90", "p99", "max", "mean");
+    static const struct { const char *name; int pct; } stats[] = {
+        {"p50", 50}, {"p90", 90}, {"p99", 99}
+    };
+    for (size_t i = 0; i < SERIES; i++) {
+        Series_t *s = series[i];
+        CsvRow(csv, s->name, "count", s->count, "count");
+        if (s->count == 0) {
+            printf("%-8s %7u\n", s->name, 0);
+            continue;
+        }
+        qsort(s->samples, s->count, sizeof(SimTime_t), Compare);
+        SimTime_t total = 0;
+        for (size_t k = 0; k < s->count; k++)
+            total += s->samples[k];
+        double mean = CYCLES_TO_US(total) / s->count;
+        double min = CYCLES_TO_US(s->samples[0]);
+        double max = CYCLES_TO_US(s->samples[s->count - 1]);
+        printf("%-8s %7zu %9.1f", s->name, s->count, min);
+        CsvRow(csv, s->name, "min", min, "us");
+        for (size_t k = 0; k < sizeof(stats) / sizeof(stats[0]); k++) {
+            double us = CYCLES_TO_US(Percentile(s, stats[k].pct));
+            printf(" %9.1f", us);
+            CsvRow(csv, s->name, stats[k].name, us, "us");
+        }
+        printf(" %9.1f %9.1f\n", max, mean);
+        CsvRow(csv, s->name, "max", max, "us");
+        CsvRow(csv, s->name, "mean", mean, "us");
+    }
+    printf("%u transfers not timed, tracking table full\n", trackDropped);
+    CsvRow(csv, "bus", "untimed", trackDropped, "count");
+
+    printf("---- throughput ----\n");
+    printf("display  %8.1f row updates/s\n", lcdUpdates / seconds);
+    printf("touch    %u of %u presses delivered\n", touchDelivered, touchPresses);
+    // SPI bytes include sensor setup, spread over the samples
+    double perSample = enviro.count ? (double)SimSPIStats.bytes / enviro.count : 0;
+    printf("enviro   %8.1f samples/s %8.1f SPI bytes/sample\n",
+           enviro.count / seconds, perSample);
+    CsvRow(csv, "display", "updates", lcdUpdates / seconds, "1/s");
+    CsvRow(csv, "touch", "presses", touchPresses, "count");
+    CsvRow(csv, "touch", "delivered", touchDelivered, "count");
+    CsvRow(csv, "enviro", "samples", enviro.count / seconds, "1/s");
+    CsvRow(csv, "enviro", "spi_bytes", perSample, "B");
+    ReportBus(csv, "i2c", &SimI2CStats, seconds);
+    double tickMean = i2cTickBusy ? (double)i2cTickBytes / i2cTickBusy : 0;
+    printf("  %.1f bytes per busy 1 ms tick, %u peak (polled engine: at most 1)\n",
+           tickMean, i2cTickPeak);
+    CsvRow(csv, "i2c", "tick_bytes_mean", tickMean, "B");
+    CsvRow(csv, "i2c", "tick_bytes_peak", i2cTickPeak, "B");
+    ReportBus(csv, "spi", &SimSPIStats, seconds);
+    // I2C transfers per device, shows which one holds the bus
+    static const struct { const char *name; uint8_t addr; } devices[] = {
+        {"lcd", 0x3E}, {"backlight", 0x2D}, {"touchpad", 0x5A},
+        {"leds", 0x38}, {"buttons", 0x39}
+    };
+    for (size_t i = 0; i < sizeof(devices) / sizeof(devices[0]); i++) {
+        double rate = SimI2CTransfersTo[devices[i].addr] / seconds;
+        printf("  %-10s %8.0f transfers/s\n", devices[i].name, rate);
+        CsvRow(csv, "i2c", devices[i].name, rate, "1/s");
+    }
+    double wakeups = SimWakeups / seconds, tickWakeups = TickingWakeups();
+    printf("core     %8.1f wakeups/s, %8.1f with 1 ms ticks\n", wakeups, tickWakeups);
+    bool failed = tickWakeups < 0 || wakeups >= tickWakeups;
+    if (tickWakeups < 0)
+        printf("ERROR: run with 1 ms ticks failed\n");
+    else if (failed)
+        printf("ERROR: tickless idle does not reduce wakeups\n");
+    CsvRow(csv, "core", "wakeups", wakeups, "1/s");
+    CsvRow(csv, "core", "wakeups_ticking", tickWakeups, "1/s");
+    CsvRow(csv, "core", "systicks", SimSysTicks / seconds, "1/s");
+
+    printf("---- tasks ----\n");
+    for (int i = 0; i < taskCount; i++) {
+        printf("%-8s %8u runs %9.1f us WCET\n", tasks[i].name, tasks[i].runs,
+               CYCLES_TO_US(tasks[i].wcet));
+        CsvRow(csv, tasks[i].name, "runs", tasks[i].runs, "count");
+        CsvRow(csv, tasks[i].name, "wcet", CYCLES_TO_US(tasks[i].wcet), "us");
+    }
+    ReportFormat(csv);
+    if (csv != NULL)
+        fclose(csv);
+    if (failed)
+        exit(EXIT_FAILURE);
+}
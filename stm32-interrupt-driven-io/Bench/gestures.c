@@ -0,0 +1,141 @@
+// Gesture checks of the touchpad driver
+// Links TouchPad.c alone against a scripted touch controller and a
+// millisecond clock, without the register simulator. Each case sets the
+// pads held at given times, ScanTouchpad() runs every ms and the
+// gestures taken at the drain times must match the expected list.
+// Prints each mismatch and exits with 1.
+//   make gestures
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "touchpad.h"
+#include "i2c.h"
+
+// --------------------------------------------------------
+// Stand-ins for the clock, the display and the I2C driver
+// --------------------------------------------------------
+static Time_t now = 0;
+static uint16_t pads = 0; // Pads the controller reports as touched
+
+Time_t TimeNow(void) { return now; }
+Time_t TimePassed(Time_t since) { return now - since; }
+Page_t GetPage(void) { return CALC; }
+
+I2C_Bus_t LeafyI2C;
+void I2C_Enable(I2C_Bus_t bus) {}
+
+// Every transfer completes at once. Reads return the touch status, raw
+// reads quiet electrodes (no noise, calibration ends after its samples).
+bool I2C_Request(I2C_Xfer_t *p) {
+    if (p->busy)
+        return false;
+    if (p->addr & 1) {
+        memset(p->data, 0, p->size);
+        if (p->size == 2) {
+            p->data[0] = pads;
+            p->data[1] = pads >> 8;
+        }
+    }
+    p->status = I2C_OK;
+    if (p->callback != NULL)
+        p->callback(p);
+    return true;
+}
+bool I2C_RequestRead(I2C_Xfer_t *wr, I2C_Xfer_t *rd) {
+    return I2C_Request(wr) && I2C_Request(rd);
+}
+
+// --------------------------------------------------------
+// Cases
+// --------------------------------------------------------
+// The calculator timing plus double taps
+static const TouchGestures_t config = {
+    .longPress = 800, .doubleTap = 300, .repeatDelay = 500, .repeatPeriod = 250,
+    .repeatMin = 80, .repeatAccel = 20, .repeatPads = 0x3FF
+};
+
+#define STEPS 8
+typedef struct {
+    const char *name;
+    struct { Time_t time; uint16_t pads; } steps[STEPS]; // Ends at pads 0
+    Time_t poll; // Gestures taken every poll ms, 0 for only at the end
+    Time_t end;
+    const char *expect;
+} Case_t;
+
+// Touch reads happen every TOUCH_POLL_MS (20 ms) from time 0, the step
+// times are on that grid so each event carries its step time
+static const Case_t cases[] = {
+    {"repeat speeds up, long press in order",
+     {{1000, 1 << N3}, {2500, 0}}, 20, 2600,
+     "PRESS 3 @1000, REPEAT 3 @1500 #1, REPEAT 3 @1750 #2, LONG 3 @1800, "
+     "REPEAT 3 @1950 #3, REPEAT 3 @2110 #4, REPEAT 3 @2238 #5, "
+     "REPEAT 3 @2341 #6, REPEAT 3 @2424 #7"},
+    {"page not polled while held drops missed repeats",
+     {{4000, 1 << N3}, {6000, 0}}, 0, 6100,
+     "PRESS 3 @4000, REPEAT 3 @4500 #1, LONG 3 @4800"},
+    {"no repeat for SHIFT, long press only",
+     {{7000, 1 << SHIFT}, {8000, 0}}, 20, 8100,
+     "PRESS 10 @7000, LONG 10 @7800"},
+    {"double tap, third tap is a press",
+     {{9000, 1 << N4}, {9060, 0}, {9200, 1 << N4}, {9260, 0}, {9400, 1 << N4}, {9460, 0}},
+     20, 9500,
+     "PRESS 4 @9000, DOUBLE 4 @9200, PRESS 4 @9400"},
+    {"taps too far apart",
+     {{10000, 1 << N4}, {10060, 0}, {10400, 1 << N4}, {10460, 0}}, 20, 10500,
+     "PRESS 4 @10000, PRESS 4 @10400"},
+    {"rollover: second pad pressed while the first is held",
+     {{11000, 1 << M1}, {11040, 1 << M1 | 1 << N2}, {11080, 1 << N2}, {11100, 0}}, 20, 11200,
+     "PRESS 1 @11000, PRESS 2 @11040"},
+    {"chord is no press",
+     {{12000, 1 << N5 | 1 << N6}, {12100, 0}}, 20, 12200,
+     ""},
+};
+
+static const char *const names[] = {"PRESS", "DOUBLE", "LONG", "REPEAT"};
+
+// Run one case from its first step to its end
+static bool Run(const Case_t *c) {
+    char log[512] = "";
+    size_t len = 0;
+    int step = 0;
+    Time_t start = c->steps[0].time;
+    for (now = start; now <= c->end; now++) {
+        while (step < STEPS && c->steps[step].time == now)
+            pads = c->steps[step++].pads;
+        ScanTouchpad();
+        if (now != c->end && (c->poll == 0 || (now - start) % c->poll != 0))
+            continue;
+        Gesture_t g;
+        while (TouchGesture(CALC, &g)) {
+            len += snprintf(log + len, sizeof(log) - len, "%s%s %d @%u", len ? ", " : "",
+                            names[g.type], g.pad, g.time);
+            if (g.type == TOUCH_REPEAT)
+                len += snprintf(log + len, sizeof(log) - len, " #%u", g.count);
+        }
+    }
+    if (strcmp(log, c->expect) == 0)
+        return true;
+    printf("%s\n  got    %s\n  expect %s\n", c->name, log, c->expect);
+    return false;
+}
+
+int main(void) {
+    TouchEnable();
+    TouchGestures(CALC, &config);
+    // Calibration takes one raw read per scan
+    for (now = 0; now < 1000; now++)
+        ScanTouchpad();
+    if (TouchCalibrating()) {
+        printf("calibration did not finish\n");
+        return 1;
+    }
+    int failed = 0;
+    size_t n = sizeof(cases) / sizeof(cases[0]);
+    for (size_t i = 0; i < n; i++)
+        failed += !Run(&cases[i]);
+    printf("gestures: %zu of %zu cases pass\n", n - failed, n);
+    return failed ? 1 : 0;
+}
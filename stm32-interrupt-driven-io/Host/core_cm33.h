@@ -0,0 +1,50 @@
+// Host build of the Cortex-M33 core header
+// Found ahead of Drivers/CMSIS/Include, replaces the Arm intrinsics of
+// cmsis_gcc.h with calls into the simulated core (see hostsim.c), then
+// pulls in the real core header for the register layouts.
+#ifndef HOST_CORE_CM33_H_
+#define HOST_CORE_CM33_H_
+
+#include <stdint.h>
+
+#define __CMSIS_GCC_H // Skip the Arm-only compiler header
+
+// Compiler attributes
+#define __ASM                    __asm
+#define __INLINE                 inline
+#define __STATIC_INLINE          static inline
+#define __STATIC_FORCEINLINE     __attribute__((always_inline)) static inline
+#define __NO_RETURN              __attribute__((__noreturn__))
+#define __USED                   __attribute__((used))
+#define __WEAK                   __attribute__((weak))
+#define __PACKED                 __attribute__((packed, aligned(1)))
+#define __PACKED_STRUCT          struct __attribute__((packed, aligned(1)))
+#define __PACKED_UNION           union __attribute__((packed, aligned(1)))
+#define __ALIGNED(x)             __attribute__((aligned(x)))
+#define __RESTRICT               __restrict
+#define __COMPILER_BARRIER()     __asm volatile("" ::: "memory")
+
+// Simulated core
+void HostWFI(void);
+void HostEnableIRQ(void);
+void HostDisableIRQ(void);
+uint32_t HostGetPRIMASK(void);
+void HostSetPRIMASK(uint32_t primask);
+
+#define __WFI()                  HostWFI()
+#define __WFE()                  HostWFI()
+#define __SEV()                  ((void)0)
+#define __NOP()                  __COMPILER_BARRIER()
+#define __ISB()                  __COMPILER_BARRIER()
+#define __DSB()                  __COMPILER_BARRIER()
+#define __DMB()                  __COMPILER_BARRIER()
+#define __enable_irq()           HostEnableIRQ()
+#define __disable_irq()          HostDisableIRQ()
+#define __get_PRIMASK()          HostGetPRIMASK()
+#define __set_PRIMASK(x)         HostSetPRIMASK(x)
+#define __CLZ(x)                 ((uint8_t)((x) ? __builtin_clz(x) : 32))
+#define __REV(x)                 __builtin_bswap32(x)
+
+#include_next "core_cm33.h"
+
+#endif /* HOST_CORE_CM33_H_ */
@@ -0,0 +1,332 @@
+// Device models of the lab platform: LCD, backlight, touchpad, I/O
+// expanders, environmental sensor and motor with rotary encoder
+#include <stddef.h>
+#include <string.h>
+#include "hostsim.h"
+#include "gpio.h"
+
+// --------------------------------------------------------
+// LCD controller (I2C 0x3E), 2 x 16 characters
+// --------------------------------------------------------
+// Each byte follows a control byte: Co = more control bytes follow,
+// RS = data (1) or command (0)
+#define LCD_CO 0x80
+#define LCD_RS 0x40
+static struct {
+    char text[2][17];
+    uint8_t addr; // Display data RAM address
+    bool control; // Next byte is a control byte
+    uint8_t ctrl; // Last control byte
+} lcd;
+void (*SimLcdChanged)(int row) = NULL;
+
+const char *SimLcdRow(int row) {
+    return lcd.text[row];
+}
+static void LcdClear(void) {
+    for (int row = 0; row < 2; row++) {
+        memset(lcd.text[row], ' ', 16);
+        lcd.text[row][16] = '\0';
+    }
+    lcd.addr = 0;
+}
+static bool LcdStart(bool read) {
+    lcd.control = true;
+    return !read;
+}
+static void LcdWrite(uint8_t data) {
+    if (lcd.control) {
+        lcd.ctrl = data;
+        lcd.control = false;
+        return;
+    }
+    lcd.control = lcd.ctrl & LCD_CO;
+    if (!(lcd.ctrl & LCD_RS)) {
+        if (data == 0x01)
+            LcdClear(); // Clear display
+        else if (data & 0x80)
+            lcd.addr = data & 0x7F; // Set DDRAM address
+        return; // Other commands do not change the text
+    }
+    int row = lcd.addr >= 0x40, col = lcd.addr & 0x3F;
+    lcd.addr++;
+    if (col < 16 && lcd.text[row][col] != (char)data) {
+        lcd.text[row][col] = data;
+        if (SimLcdChanged != NULL)
+            SimLcdChanged(row);
+    }
+}
+static uint8_t LcdRead(void) {
+    return 0xFF;
+}
+
+// --------------------------------------------------------
+// Register-file devices: backlight (0x2D) and touchpad (0x5A)
+// --------------------------------------------------------
+// First byte written selects a register, later bytes auto-increment
+typedef struct {
+    uint8_t regs[256];
+    uint8_t ptr; // Wraps at 256
+    bool addressed;
+} RegFile_t;
+static RegFile_t blt, pad;
+
+static void RegStart(RegFile_t *d, bool read) {
+    if (!read)
+        d->addressed = false;
+}
+static void RegWrite(RegFile_t *d, uint8_t data) {
+    if (!d->addressed) {
+        d->ptr = data;
+        d->addressed = true;
+    }
+    else
+        d->regs[d->ptr++] = data;
+}
+static uint8_t RegRead(RegFile_t *d) {
+    return d->regs[d->ptr++];
+}
+static bool BltStart(bool read) { RegStart(&blt, read); return true; }
+static void BltWrite(uint8_t data) { RegWrite(&blt, data); }
+static uint8_t BltRead(void) { return RegRead(&blt); }
+// The touchpad IRQ output goes low when the touch status changes and is
+// released by reading it, wired to TOUCH_INT_PIN if the image uses it
+static void PadIrq(bool asserted) {
+#ifdef TOUCH_INT_PIN
+    static const Pin_t irq = TOUCH_INT_PIN;
+    SimPin(irq.port, irq.bit, !asserted);
+#endif
+}
+static bool PadStart(bool read) { RegStart(&pad, read); return true; }
+static void PadWrite(uint8_t data) { RegWrite(&pad, data); }
+static uint8_t PadRead(void) {
+    if (pad.ptr < 2)
+        PadIrq(false);
+    return RegRead(&pad);
+}
+
+uint32_t SimBacklight(void) {
+    return blt.regs[1] << 16 | blt.regs[2] << 8 | blt.regs[3];
+}
+// Untouched electrodes: filtered data 0x04..0x1B (10 bits) at the
+// baseline 0x1E..0x29 (8 MSBs)
+static void PadIdle(void) {
+    for (int i = 0; i < 12; i++) {
+        uint16_t filtered = 720 + 8 * i;
+        pad.regs[0x04 + 2 * i] = filtered & 0xFF;
+        pad.regs[0x05 + 2 * i] = filtered >> 8;
+        pad.regs[0x1E + i] = filtered >> 2;
+    }
+}
+// Touch status registers 0x00 and 0x01, one bit per electrode
+void SimTouch(uint16_t pads) {
+    if (pad.regs[0] != (pads & 0xFF) || pad.regs[1] != (pads >> 8 & 0x1F))
+        PadIrq(true);
+    pad.regs[0] = pads & 0xFF;
+    pad.regs[1] = pads >> 8 & 0x1F;
+}
+
+// --------------------------------------------------------
+// I/O expanders: LEDs (0x38) and push buttons (0x39), active low
+// --------------------------------------------------------
+static uint8_t leds = 0xFF, buttons = 0xFF;
+
+static bool IoxStart(bool read) { return true; }
+static void IoxWrite(uint8_t data) { leds = data; }
+static uint8_t IoxRead(void) { return buttons; }
+static void IoxStop(void) {}
+
+uint8_t SimLEDs(void) {
+    return ~leds;
+}
+void SimButtons(uint8_t pressed) {
+    buttons = ~pressed;
+}
+
+static void Nothing(void) {}
+static const SimI2CDevice_t devices[] = {
+    {0x3E, LcdStart, LcdWrite, LcdRead, Nothing},
+    {0x2D, BltStart, BltWrite, BltRead, Nothing},
+    {0x5A, PadStart, PadWrite, PadRead, Nothing},
+    {0x38, IoxStart, IoxWrite, IoxRead, IoxStop},
+    {0x39, IoxStart, IoxWrite, IoxRead, IoxStop}
+};
+const SimI2CDevice_t *SimI2CFind(uint8_t addr) {
+    for (size_t i = 0; i < sizeof(devices) / sizeof(devices[0]); i++)
+        if (devices[i].addr == addr)
+            return &devices[i];
+    return NULL;
+}
+
+// --------------------------------------------------------
+// Environmental sensor (SPI, select on PD14)
+// --------------------------------------------------------
+// 7-bit SPI addresses map to registers 0x80..0xFF on page 0 and
+// 0x00..0x7F on page 1, selected by bit 4 of register 0x73
+#define BME_PAGE 0x73
+#define BME_STATUS 0x1D
+#define BME_CTRL_HUM 0x72
+#define BME_CTRL_MEAS 0x74
+#define BME_RESET 0xE0
+#define BME_ID 0xD0
+static void BmeDone(void *arg);
+static struct {
+    uint8_t regs[256];
+    bool selected;
+    bool expectAddr; // Next byte is a command (R/W and address)
+    bool read;
+    uint8_t addr;
+    double temp, hum;
+    SimEvent_t conversion;
+} bme = {.conversion = {.fn = BmeDone}};
+
+// Calibration chosen so the compensation formulas invert exactly
+#define PAR_T1 26000
+#define PAR_T2 26000
+#define PAR_H1 700
+#define PAR_H2 1000
+#define PAR_H4 45
+#define PAR_H5 20
+
+void SimEnviro(double tempC, double humidity) {
+    bme.temp = tempC;
+    bme.hum = humidity;
+}
+static void BmeReset(void) {
+    memset(bme.regs, 0, sizeof(bme.regs));
+    bme.regs[BME_ID] = 0x61;
+    bme.regs[0xE9] = PAR_T1 & 0xFF;
+    bme.regs[0xEA] = PAR_T1 >> 8;
+    bme.regs[0x8A] = PAR_T2 & 0xFF;
+    bme.regs[0x8B] = PAR_T2 >> 8;
+    bme.regs[0xE1] = PAR_H2 >> 4;
+    bme.regs[0xE2] = (PAR_H2 & 0xF) << 4 | (PAR_H1 & 0xF);
+    bme.regs[0xE3] = PAR_H1 >> 4;
+    bme.regs[0xE5] = PAR_H4;
+    bme.regs[0xE6] = PAR_H5;
+    // Readings of a skipped measurement
+    bme.regs[0x22] = 0x80;
+    bme.regs[0x25] = 0x80;
+    SimCancel(&bme.conversion);
+}
+static int BmeReg(uint8_t addr) {
+    if (addr == BME_PAGE)
+        return BME_PAGE;
+    return bme.regs[BME_PAGE] & 0x10 ? addr : addr | 0x80;
+}
+// Measurement time: 1963 us per oversampling cycle plus switching
+// and wake-up overhead, per the sensor datasheet
+static SimTime_t BmeDuration(void) {
+    static const int cycles[8] = {0, 1, 2, 4, 8, 16, 16, 16};
+    int n = cycles[bme.regs[BME_CTRL_MEAS] >> 5]
+          + cycles[bme.regs[BME_CTRL_MEAS] >> 2 & 7]
+          + cycles[bme.regs[BME_CTRL_HUM] & 7];
+    return SIM_US(n * 1963 + 477 * 4 + 477 * 5 + 500);
+}
+static void BmeDone(void *arg) {
+    double t = bme.temp;
+    if (bme.regs[BME_CTRL_MEAS] >> 5) {
+        uint32_t adc = (t * 5120.0 / PAR_T2 + PAR_T1 / 1024.0) * 16384.0;
+        bme.regs[0x22] = adc >> 12;
+        bme.regs[0x23] = adc >> 4;
+        bme.regs[0x24] = adc << 4;
+    }
+    if (bme.regs[BME_CTRL_HUM] & 7) {
+        double gain = PAR_H2 / 262144.0
+            * (1.0 + PAR_H4 / 16384.0 * t + PAR_H5 / 1048576.0 * t * t);
+        uint16_t adc = bme.hum / gain + PAR_H1 * 16.0;
+        bme.regs[0x25] = adc >> 8;
+        bme.regs[0x26] = adc;
+    }
+    bme.regs[BME_CTRL_MEAS] &= ~3; // Back to sleep mode
+    bme.regs[BME_STATUS] = 0x80; // New data
+}
+static void BmeWrite(int reg, uint8_t data) {
+    if (reg == BME_RESET) {
+        if (data == 0xB6)
+            BmeReset();
+        return;
+    }
+    bme.regs[reg] = data;
+    if (reg == BME_CTRL_MEAS && (data & 3) == 1) {
+        // Forced mode: one measurement, then sleep
+        bme.regs[BME_STATUS] = 0x20; // Measuring
+        SimAt(&bme.conversion, SimNow() + BmeDuration());
+    }
+}
+void SimSpiSelect(bool selected) {
+    if (selected && !bme.selected) {
+        bme.expectAddr = true;
+        SimSPIStats.transfers++;
+    }
+    bme.selected = selected;
+}
+uint8_t SimSpiTransfer(uint8_t mosi) {
+    if (!bme.selected)
+        return 0xFF;
+    if (bme.expectAddr) {
+        bme.read = mosi & 0x80;
+        bme.addr = mosi & 0x7F;
+        bme.expectAddr = false;
+        return 0xFF;
+    }
+    if (bme.read)
+        return bme.regs[BmeReg(bme.addr++ & 0x7F)];
+    // Writes are address/data pairs
+    BmeWrite(BmeReg(bme.addr), mosi);
+    bme.expectAddr = true;
+    return 0xFF;
+}
+
+// --------------------------------------------------------
+// Motor (TIM1 CH1 PWM, PB10/PB11 direction, PE15 standby) with
+// quadrature encoder on PB0/PB1
+// --------------------------------------------------------
+#define MOTOR_MAX_RPM 350.0
+#define ENCODER_PULSES (11 * 34) // Per revolution and channel
+#define MOTOR_IDLE_POLL SIM_MS(1)
+static void EncoderStep(void *arg);
+static SimEvent_t encoder = {.fn = EncoderStep};
+static uint16_t outputs[8]; // Output data of GPIOA..GPIOH
+
+static double MotorRPM(void) {
+    bool stby = outputs[4] & 1 << 15;
+    bool ai1 = outputs[1] & 1 << 10, ai2 = outputs[1] & 1 << 11;
+    uint32_t arr = TIM1->ARR & 0xFFFF;
+    if (!stby || ai1 == ai2 || !(TIM1->CR1 & TIM_CR1_CEN) || arr == 0)
+        return 0;
+    double duty = (double)(TIM1->CCR1 & 0xFFFF) / (arr + 1);
+    return (duty > 1 ? 1 : duty) * MOTOR_MAX_RPM * (ai1 ? -1 : 1);
+}
+// Quarter period steps: A rises, B rises, A falls, B falls (reversed
+// sequence for the other direction)
+static void EncoderStep(void *arg) {
+    static int phase = 0;
+    double rpm = MotorRPM();
+    if (rpm == 0) {
+        SimAt(&encoder, SimNow() + MOTOR_IDLE_POLL);
+        return;
+    }
+    phase = (phase + (rpm > 0 ? 1 : 3)) % 4;
+    SimPin(GPIOB, 0, phase == 0 || phase == 1);
+    SimPin(GPIOB, 1, phase == 1 || phase == 2);
+    double rpmAbs = rpm > 0 ? rpm : -rpm;
+    SimAt(&encoder, SimNow() + SIM_CPU_HZ * 60.0 / (rpmAbs * ENCODER_PULSES * 4));
+}
+
+// --------------------------------------------------------
+// Pins and start-up
+// --------------------------------------------------------
+void SimDevicePins(int port, uint16_t odr) {
+    outputs[port] = odr;
+    if (port == 3)
+        SimSpiSelect(!(odr & 1 << 14)); // PD14 active low
+}
+void SimDevicesInit(void) {
+    LcdClear();
+    PadIrq(false);
+    PadIdle();
+    BmeReset();
+    SimEnviro(22.5, 45.0);
+    SimAt(&encoder, MOTOR_IDLE_POLL);
+}
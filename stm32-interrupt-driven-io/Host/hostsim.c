@@ -0,0 +1,455 @@
+// Host simulation core: trapped register access, virtual time, NVIC,
+// SysTick and the DWT cycle counter
+//
+// Register blocks are mapped at their CMSIS addresses with no access
+// rights. An access faults, the handler opens the page, lets the model
+// refresh the register and single-steps the instruction. The trap after
+// the step runs the side effects of the access (write-1-to-clear flags,
+// transfer starts, ...), closes the pages and takes pending interrupts.
+// The fault address, access type and single-step come from the x86-64
+// Linux signal context (REG_ERR, REG_EFL and the trap flag), so the
+// simulator builds on x86-64 Linux only.
+#if !defined(__x86_64__) || !defined(__linux__)
+#error "The host simulator needs x86-64 Linux (signal context and trap flag)"
+#endif
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include "hostsim.h"
+
+// Register blocks at their CMSIS addresses
+static const struct {
+    uintptr_t base;
+    size_t size;
+} blocks[] = {
+    {PERIPH_BASE_NS, 0x30000}, // APB1, APB2, AHB1 (DMA, RCC, EXTI)
+    {AHB2PERIPH_BASE_NS, 0x10000}, // GPIO ports, ADC
+    {ITM_BASE, 0x10000} // ITM, DWT, SysTick, NVIC, SCB
+};
+#define BLOCKS (sizeof(blocks) / sizeof(blocks[0]))
+#define EFLAGS_TF 0x100 // x86 single-step flag
+#define PAGE_FAULT_WRITE 0x2 // Page fault error code: write access
+#define EXCEPTION_CYCLES 12 // Exception entry
+
+// --------------------------------------------------------
+// Virtual time
+// --------------------------------------------------------
+static SimTime_t now = 0;
+static SimTime_t stopAt = SIM_MS(1000);
+static SimEvent_t *events = NULL; // Armed events in time order
+
+SimTime_t SimNow(void) {
+    return now;
+}
+void SimStopAt(SimTime_t at) {
+    stopAt = at;
+}
+void SimCancel(SimEvent_t *ev) {
+    for (SimEvent_t **p = &events; *p != NULL; p = &(*p)->next)
+        if (*p == ev) {
+            *p = ev->next;
+            break;
+        }
+    ev->armed = false;
+}
+void SimAt(SimEvent_t *ev, SimTime_t at) {
+    if (ev->armed)
+        SimCancel(ev);
+    if (at < now)
+        at = now;
+    ev->at = at;
+    ev->armed = true;
+    // Events due at the same time run in the order they were armed
+    SimEvent_t **p = &events;
+    while (*p != NULL && (*p)->at <= at)
+        p = &(*p)->next;
+    ev->next = *p;
+    *p = ev;
+}
+// Run model events up to the given time
+static void Advance(SimTime_t to) {
+    while (events != NULL && events->at <= to) {
+        SimEvent_t *ev = events;
+        events = ev->next;
+        ev->armed = false;
+        now = ev->at;
+        ev->fn(ev->arg);
+    }
+    if (to > now)
+        now = to;
+}
+
+// --------------------------------------------------------
+// Register protection
+// --------------------------------------------------------
+// Pages are opened one at a time as the firmware access or the models
+// touch them, and all closed again when the simulator code returns.
+#define PAGE 4096
+#define MAX_OPEN 64
+static int unlocked = 0; // Nesting count of simulator code
+static uintptr_t open[MAX_OPEN];
+static int opened = 0;
+
+static void OpenPage(uintptr_t addr) {
+    uintptr_t page = addr & ~(uintptr_t)(PAGE - 1);
+    for (int i = 0; i < opened; i++)
+        if (open[i] == page)
+            return;
+    if (opened == MAX_OPEN) {
+        fprintf(stderr, "hostsim: too many register pages open\n");
+        _exit(EXIT_FAILURE);
+    }
+    mprotect((void *)page, PAGE, PROT_READ | PROT_WRITE);
+    open[opened++] = page;
+}
+static void Unlock(void) {
+    unlocked++;
+}
+static void Lock(void) {
+    if (--unlocked == 0)
+        while (opened > 0)
+            mprotect((void *)open[--opened], PAGE, PROT_NONE);
+}
+
+// --------------------------------------------------------
+// NVIC and exception dispatch
+// --------------------------------------------------------
+#define VECTORS(X) \
+    X(EXTI0) X(EXTI1) X(EXTI2) X(EXTI3) X(EXTI4) X(EXTI5) X(EXTI6) X(EXTI7) \
+    X(EXTI8) X(EXTI9) X(EXTI10) X(EXTI11) X(EXTI12) X(EXTI13) X(EXTI14) X(EXTI15) \
+    X(DMA1_Channel1) X(DMA1_Channel2) X(DMA1_Channel3) X(DMA1_Channel4) \
+    X(DMA1_Channel5) X(DMA1_Channel6) X(DMA1_Channel7) X(DMA1_Channel8) \
+    X(ADC1_2) X(TIM1_BRK) X(TIM1_UP) X(TIM1_TRG_COM) X(TIM1_CC) \
+    X(TIM2) X(TIM3) X(TIM4) X(TIM5) X(TIM6) X(TIM7) \
+    X(TIM8_BRK) X(TIM8_UP) X(TIM8_TRG_COM) X(TIM8_CC) \
+    X(I2C1_EV) X(I2C1_ER) X(I2C2_EV) X(I2C2_ER) \
+    X(I2C3_EV) X(I2C3_ER) X(I2C4_EV) X(I2C4_ER) \
+    X(SPI1) X(SPI2) X(SPI3)
+// Handlers the firmware does not define resolve to NULL
+#define X(name) extern void name##_IRQHandler(void) __attribute__((weak));
+VECTORS(X)
+#undef X
+extern void SysTick_Handler(void) __attribute__((weak));
+#define X(name) [name##_IRQn] = {#name, name##_IRQHandler},
+static const struct {
+    const char *name;
+    void (*handler)(void);
+} vectors[SIM_IRQS] = { VECTORS(X) };
+#undef X
+
+static uint32_t enabled[SIM_IRQS / 32];
+static uint32_t pending[SIM_IRQS / 32];
+static bool sysTickPending = false;
+static uint32_t primask = 0;
+static int active = 1 << __NVIC_PRIO_BITS; // Execution priority, thread mode lowest
+static SimTime_t raised[SIM_IRQS]; // Time each pending IRQ was raised
+uint32_t SimIrqCount[SIM_IRQS];
+uint32_t SimSysTicks = 0;
+uint32_t SimWakeups = 0;
+void (*SimAccessHook)(void) = NULL;
+void (*SimIrqHook)(IRQn_Type irq, SimTime_t raised, SimTime_t entry) = NULL;
+
+void SimIrq(IRQn_Type irq) {
+    if (!(pending[irq / 32] & 1u << irq % 32))
+        raised[irq] = now;
+    pending[irq / 32] |= 1u << irq % 32;
+}
+static int Priority(int irq) {
+    uint8_t pri = irq < 0 ? SCB->SHPR[12 + irq] : NVIC->IPR[irq];
+    return pri >> (8 - __NVIC_PRIO_BITS);
+}
+// Highest priority pending exception able to preempt, or SIM_IRQS
+static int NextException(int *pri) {
+    int best = SIM_IRQS;
+    *pri = active;
+    if (sysTickPending && Priority(SysTick_IRQn) < *pri) {
+        best = SysTick_IRQn;
+        *pri = Priority(SysTick_IRQn);
+    }
+    for (int i = 0; i < SIM_IRQS / 32; i++)
+        for (uint32_t bits = pending[i] & enabled[i]; bits; bits &= bits - 1) {
+            int irq = 32 * i + __builtin_ctz(bits);
+            if (Priority(irq) < *pri) {
+                best = irq;
+                *pri = Priority(irq);
+            }
+        }
+    return best;
+}
+// Take pending interrupts, called where the core may be interrupted
+static void Dispatch(void) {
+    while (!primask) {
+        int pri;
+        Unlock();
+        int irq = NextException(&pri);
+        if (irq == SysTick_IRQn)
+            sysTickPending = false;
+        else if (irq != SIM_IRQS)
+            pending[irq / 32] &= ~(1u << irq % 32);
+        if (irq != SIM_IRQS)
+            Advance(now + EXCEPTION_CYCLES);
+        Lock();
+        if (irq == SIM_IRQS)
+            break;
+        void (*handler)(void) = irq < 0 ? SysTick_Handler : vectors[irq].handler;
+        if (handler == NULL) {
+            fprintf(stderr, "hostsim: no handler for IRQ %d\n", irq);
+            exit(EXIT_FAILURE);
+        }
+        if (irq < 0)
+            SimSysTicks++;
+        else
+            SimIrqCount[irq]++;
+        int was = active;
+        SimTime_t entry = now;
+        active = pri;
+        handler();
+        active = was;
+        if (irq >= 0 && SimIrqHook != NULL)
+            SimIrqHook(irq, raised[irq], entry);
+    }
+}
+
+// Intrinsics of the host core_cm33.h
+void HostEnableIRQ(void) {
+    primask = 0;
+    Dispatch();
+}
+void HostDisableIRQ(void) {
+    primask = 1;
+}
+uint32_t HostGetPRIMASK(void) {
+    return primask;
+}
+void HostSetPRIMASK(uint32_t mask) {
+    primask = mask & 1;
+    Dispatch();
+}
+// Sleep until an interrupt is pending, even if PRIMASK masks it
+void HostWFI(void) {
+    int pri;
+    Unlock();
+    if (SimAccessHook != NULL)
+        SimAccessHook();
+    while (NextException(&pri) == SIM_IRQS) {
+        if (events == NULL || events->at >= stopAt) {
+            if (events == NULL)
+                fprintf(stderr, "hostsim: sleeping with nothing to wake the core\n");
+            Advance(stopAt);
+            SimReport();
+            exit(EXIT_SUCCESS);
+        }
+        Advance(events->at);
+    }
+    SimWakeups++;
+    Lock();
+    Dispatch();
+}
+
+// --------------------------------------------------------
+// SysTick and DWT
+// --------------------------------------------------------
+static void SysTickZero(void *arg);
+static SimEvent_t tick = {.fn = SysTickZero};
+static uint32_t stopped = 0; // Counter value while disabled
+static SimTime_t cyclesBase = 0; // Time at which CYCCNT was 0
+
+// Counter runs down to 0 at the armed event
+static uint32_t SysTickValue(void) {
+    return tick.armed ? (uint32_t)(tick.at - now) : stopped;
+}
+static void SysTickZero(void *arg) {
+    SysTick->CTRL |= SysTick_CTRL_COUNTFLAG_Msk;
+    if (SysTick->CTRL & SysTick_CTRL_TICKINT_Msk)
+        sysTickPending = true;
+    // Reload on the next cycle, then count LOAD cycles to 0
+    uint32_t load = SysTick->LOAD & SysTick_LOAD_RELOAD_Msk;
+    stopped = 0;
+    if (load != 0)
+        SimAt(&tick, now + 1 + load);
+}
+static void SysTickWrite(uintptr_t addr, uint32_t old) {
+    uint32_t load = SysTick->LOAD & SysTick_LOAD_RELOAD_Msk;
+    if (addr == (uintptr_t)&SysTick->VAL) {
+        // Any write clears the counter, reloaded on the next cycle
+        stopped = 0;
+        SysTick->CTRL &= ~SysTick_CTRL_COUNTFLAG_Msk;
+        if (tick.armed)
+            SimAt(&tick, now + 1 + load);
+    }
+    else if (addr == (uintptr_t)&SysTick->CTRL) {
+        bool was = old & SysTick_CTRL_ENABLE_Msk;
+        bool is = SysTick->CTRL & SysTick_CTRL_ENABLE_Msk;
+        if (!was && is)
+            SimAt(&tick, now + (stopped ? stopped : 1 + load));
+        else if (was && !is) {
+            stopped = SysTickValue();
+            SimCancel(&tick);
+        }
+    }
+}
+
+// Core registers before an access
+static void CoreBefore(uintptr_t addr) {
+    uint32_t *reg = (uint32_t *)addr;
+    uintptr_t nvic = (uintptr_t)NVIC;
+    if (addr == (uintptr_t)&SysTick->VAL)
+        *reg = SysTickValue();
+    else if (addr == (uintptr_t)&DWT->CYCCNT)
+        *reg = (uint32_t)(now - cyclesBase);
+    else if (addr == (uintptr_t)&SCB->ICSR)
+        *reg = sysTickPending ? SCB_ICSR_PENDSTSET_Msk : 0;
+    else if (addr >= nvic && addr < (uintptr_t)&NVIC->IABR[0]) {
+        // ISER, ICER, ISPR and ICPR read back the shadow state
+        int i = (addr - nvic) / 4 % 32;
+        if (i < SIM_IRQS / 32)
+            *reg = addr < (uintptr_t)&NVIC->ISPR[0] ? enabled[i] : pending[i];
+    }
+}
+// Core registers after an access
+static void CoreAfter(uintptr_t addr, bool write, uint32_t old) {
+    uint32_t *reg = (uint32_t *)addr;
+    uintptr_t nvic = (uintptr_t)NVIC;
+    if (!write) {
+        if (addr == (uintptr_t)&SysTick->CTRL)
+            *reg &= ~SysTick_CTRL_COUNTFLAG_Msk; // Cleared by reading
+        return;
+    }
+    if (addr >= (uintptr_t)SysTick && addr < (uintptr_t)SysTick + sizeof(*SysTick))
+        SysTickWrite(addr, old);
+    else if (addr == (uintptr_t)&DWT->CYCCNT)
+        cyclesBase = now - *reg;
+    else if (addr == (uintptr_t)&SCB->ICSR) {
+        if (*reg & SCB_ICSR_PENDSTSET_Msk)
+            sysTickPending = true;
+        if (*reg & SCB_ICSR_PENDSTCLR_Msk)
+            sysTickPending = false;
+    }
+    else if (addr >= nvic && addr < (uintptr_t)&NVIC->IABR[0]) {
+        // Write-1-to-set and write-1-to-clear pairs
+        int i = (addr - nvic) / 4 % 32;
+        if (i >= SIM_IRQS / 32)
+            return;
+        if (addr < (uintptr_t)&NVIC->ICER[0])
+            enabled[i] |= *reg;
+        else if (addr < (uintptr_t)&NVIC->ISPR[0])
+            enabled[i] &= ~*reg;
+        else if (addr < (uintptr_t)&NVIC->ICPR[0])
+            pending[i] |= *reg;
+        else
+            pending[i] &= ~*reg;
+    }
+}
+
+// --------------------------------------------------------
+// Register access traps
+// --------------------------------------------------------
+static struct {
+    uintptr_t addr; // Word containing the access
+    bool write;
+    uint32_t old; // Word before the access
+} trapped;
+
+static bool InBlocks(uintptr_t addr) {
+    for (size_t i = 0; i < BLOCKS; i++)
+        if (addr >= blocks[i].base && addr < blocks[i].base + blocks[i].size)
+            return true;
+    return false;
+}
+static void OnFault(int sig, siginfo_t *si, void *context) {
+    ucontext_t *uc = context;
+    uintptr_t addr = (uintptr_t)si->si_addr;
+    if (!InBlocks(addr)) {
+        // A real crash, let it happen with the default action
+        signal(SIGSEGV, SIG_DFL);
+        return;
+    }
+    OpenPage(addr);
+    if (unlocked)
+        return; // Register touched by the models, retry
+    Unlock();
+    Advance(now + SIM_ACCESS_CYCLES);
+    if (now > stopAt + SIM_MS(1000)) {
+        fprintf(stderr, "hostsim: firmware spinning past the end of the run\n");
+        _exit(EXIT_FAILURE);
+    }
+    trapped.addr = addr & ~(uintptr_t)3;
+    trapped.write = uc->uc_mcontext.gregs[REG_ERR] & PAGE_FAULT_WRITE;
+    if (trapped.addr >= ITM_BASE)
+        CoreBefore(trapped.addr);
+    else
+        SimPeriphBefore(trapped.addr, trapped.write);
+    trapped.old = *(uint32_t *)trapped.addr;
+    uc->uc_mcontext.gregs[REG_EFL] |= EFLAGS_TF;
+}
+static void OnStep(int sig, siginfo_t *si, void *context) {
+    ucontext_t *uc = context;
+    uc->uc_mcontext.gregs[REG_EFL] &= ~EFLAGS_TF;
+    uintptr_t addr = trapped.addr;
+    bool write = trapped.write || *(uint32_t *)addr != trapped.old;
+    if (addr >= ITM_BASE)
+        CoreAfter(addr, write, trapped.old);
+    else
+        SimPeriphAfter(addr, write, trapped.old);
+    if (SimAccessHook != NULL)
+        SimAccessHook();
+    Lock();
+    // Interrupts preempt the firmware at register accesses
+    Dispatch();
+}
+
+// --------------------------------------------------------
+// Start-up and reporting
+// --------------------------------------------------------
+__attribute__((weak)) void SimScenario(int argc, char **argv) {
+    if (argc > 1)
+        SimStopAt(SIM_MS(strtoul(argv[1], NULL, 0)));
+}
+__attribute__((weak)) void SimReport(void) {
+    SimSummary();
+}
+static void PrintBus(const char *name, const SimBusStats_t *s) {
+    printf("%s: %u transfers, %u bytes, %u NACKs, %.1f%% busy\n", name,
+           s->transfers, s->bytes, s->nacks, 100.0 * s->busy / now);
+}
+void SimSummary(void) {
+    fflush(stdout);
+    printf("---- %.3f s virtual time ----\n", (double)now / SIM_CPU_HZ);
+    printf("Wakeups: %u (%.0f/s), SysTicks: %u\n", SimWakeups,
+           SimWakeups * (double)SIM_CPU_HZ / now, SimSysTicks);
+    for (int i = 0; i < SIM_IRQS; i++)
+        if (SimIrqCount[i])
+            printf("IRQ %-14s %u\n", vectors[i].name, SimIrqCount[i]);
+    PrintBus("I2C", &SimI2CStats);
+    PrintBus("SPI", &SimSPIStats);
+    printf("LCD: [%s] [%s] backlight %06X, LEDs %02X\n",
+           SimLcdRow(0), SimLcdRow(1), SimBacklight(), SimLEDs());
+}
+// Runs before main(), glibc passes the command line to constructors
+__attribute__((constructor)) static void SimInit(int argc, char **argv) {
+    for (size_t i = 0; i < BLOCKS; i++)
+        if (mmap((void *)blocks[i].base, blocks[i].size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0)
+            != (void *)blocks[i].base) {
+            perror("hostsim: mapping peripheral registers");
+            exit(EXIT_FAILURE);
+        }
+    struct sigaction sa = {0};
+    sa.sa_flags = SA_SIGINFO | SA_NODEFER; // Handlers nest inside interrupts
+    sa.sa_sigaction = OnFault;
+    sigaction(SIGSEGV, &sa, NULL);
+    sa.sa_sigaction = OnStep;
+    sigaction(SIGTRAP, &sa, NULL);
+    Unlock();
+    SimPeriphInit();
+    SimDevicesInit();
+    SimScenario(argc, argv);
+    Lock();
+    for (size_t i = 0; i < BLOCKS; i++)
+        mprotect((void *)blocks[i].base, blocks[i].size, PROT_NONE);
+}
@@ -0,0 +1,101 @@
+// Host simulation of the lab platform
+// The firmware runs unmodified in a Linux process. Peripheral registers
+// live at their CMSIS addresses in protected pages, every access traps
+// into the peripheral models and costs a few cycles of virtual time.
+#ifndef HOSTSIM_H_
+#define HOSTSIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32l5xx.h"
+
+// Virtual time in CPU cycles, the core always runs at 48 MHz
+typedef uint64_t SimTime_t;
+#define SIM_CPU_HZ 48000000ULL
+#define SIM_US(us) ((SimTime_t)(us) * (SIM_CPU_HZ / 1000000))
+#define SIM_MS(ms) ((SimTime_t)(ms) * (SIM_CPU_HZ / 1000))
+#define SIM_ACCESS_CYCLES 4 // Cost of one peripheral register access
+
+// Scheduled model event, owned by the model that arms it
+typedef struct SimEvent_t {
+    SimTime_t at;
+    bool armed;
+    void (*fn)(void *arg);
+    void *arg;
+    struct SimEvent_t *next;
+} SimEvent_t;
+
+// --------------------------------------------------------
+// Scenario interface
+// --------------------------------------------------------
+SimTime_t SimNow(void);
+void SimAt(SimEvent_t *ev, SimTime_t at); // Arm (or re-arm) an event
+void SimCancel(SimEvent_t *ev);
+void SimStopAt(SimTime_t at); // End of the run, default from argv[1] in ms
+// Called once before main() with the command line, and at the end of
+// the run. Weak defaults run for argv[1] ms and print SimSummary().
+void SimScenario(int argc, char **argv);
+void SimReport(void);
+void SimSummary(void);
+
+// Inputs
+void SimPin(GPIO_TypeDef *port, int bit, int level); // Drive an input pin
+void SimTouch(uint16_t pads); // Touchpad electrodes held, bit per pad
+void SimButtons(uint8_t pressed); // I/O expander push buttons
+void SimPot(uint16_t value); // Potentiometer, 12-bit ADC counts
+void SimEnviro(double tempC, double humidity); // Environmental sensor
+
+// Observations
+typedef struct {
+    SimTime_t busy; // Cycles with the bus active
+    uint32_t transfers; // START conditions, including repeated
+    uint32_t bytes; // Address and data bytes on the wire
+    uint32_t nacks;
+} SimBusStats_t;
+extern SimBusStats_t SimI2CStats, SimSPIStats;
+extern uint32_t SimI2CTransfersTo[128]; // START conditions per 7-bit address
+#define SIM_IRQS 128
+extern uint32_t SimWakeups; // Exits from WFI
+extern uint32_t SimSysTicks; // SysTick handler entries
+extern uint32_t SimIrqCount[SIM_IRQS]; // Handler entries per IRQ number
+const char *SimLcdRow(int row); // Text on the glass
+extern void (*SimLcdChanged)(int row); // Called when a character changes
+uint32_t SimBacklight(void); // 0xRRGGBB
+uint8_t SimLEDs(void); // I/O expander LED outputs, 1 = lit
+// Called when an interrupt handler returns, with the time the IRQ was
+// raised and the time the handler was entered
+extern void (*SimIrqHook)(IRQn_Type irq, SimTime_t raised, SimTime_t entry);
+// Called after every register access and before the core sleeps, lets
+// a scenario watch firmware state change at the time it happens
+extern void (*SimAccessHook)(void);
+
+// --------------------------------------------------------
+// Model interface
+// --------------------------------------------------------
+void SimIrq(IRQn_Type irq); // Set an interrupt pending
+// Register access hooks of the peripheral models, before the access
+// and after it with the previous word contents
+void SimPeriphBefore(uintptr_t addr, bool write);
+void SimPeriphAfter(uintptr_t addr, bool write, uint32_t old);
+void SimPeriphInit(void);
+// DMA requests, return false when the channel is not ready
+bool SimDmaRead(int request, uint8_t *data); // Memory to peripheral
+bool SimDmaWrite(int request, uint8_t data); // Peripheral to memory
+// GPIO output changes seen by devices
+void SimDevicePins(int port, uint16_t odr);
+
+// I2C target devices, addressed by 7-bit address
+typedef struct {
+    uint8_t addr;
+    bool (*start)(bool read); // Address phase, returns ACK
+    void (*write)(uint8_t data);
+    uint8_t (*read)(void);
+    void (*stop)(void);
+} SimI2CDevice_t;
+const SimI2CDevice_t *SimI2CFind(uint8_t addr);
+// SPI target on the environmental sensor select pin
+void SimSpiSelect(bool selected);
+uint8_t SimSpiTransfer(uint8_t mosi);
+void SimDevicesInit(void);
+
+#endif /* HOSTSIM_H_ */
@@ -0,0 +1,65 @@
+// Host build of the Calculator math routines in Src/maths.s
+#include <stdint.h>
+
+uint32_t Increment(uint32_t num) {
+    return num + 1;
+}
+uint32_t Decrement(uint32_t num) {
+    return num - 1;
+}
+// op: 1=Add, 2=Sub, 3=Mul, 4=Div (unsigned; /0 => 0)
+uint32_t FourOp(uint32_t op, uint32_t a, uint32_t b) {
+    switch (op) {
+    case 1: return a + b;
+    case 2: return a - b;
+    case 3: return a * b;
+    case 4: return b ? a / b : 0;
+    default: return 0;
+    }
+}
+uint32_t Gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+uint32_t Fact(uint32_t n) {
+    uint32_t acc = 1;
+    for (; n > 0; n--)
+        acc *= n;
+    return acc;
+}
+uint32_t Fib(uint32_t n) {
+    uint32_t a = 0, b = 1;
+    for (; n > 0; n--) {
+        uint32_t t = a + b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+// Bubble sort in place, ascending
+uint32_t Sort(uint32_t *p, uint32_t n) {
+    for (int swapped = n > 1; swapped; n--) {
+        swapped = 0;
+        for (uint32_t i = 0; i + 1 < n; i++)
+            if (p[i] > p[i + 1]) {
+                uint32_t t = p[i];
+                p[i] = p[i + 1];
+                p[i + 1] = t;
+                swapped = 1;
+            }
+    }
+    return 0;
+}
+// Average to 1 decimal place: (sum * 10) / n
+uint32_t Avg1dp(uint32_t *p, uint32_t n) {
+    uint32_t sum = 0;
+    if (n == 0)
+        return 0;
+    for (uint32_t i = 0; i < n; i++)
+        sum += p[i];
+    return sum * 10 / n;
+}
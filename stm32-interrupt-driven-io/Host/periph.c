@@ -0,0 +1,602 @@
+// Peripheral models: GPIO, EXTI, timers, ADC, DMA, I2C and SPI
+// Registers are plain memory, the models only act on accesses with side
+// effects and on their own timed events.
+#include <stddef.h>
+#include <string.h>
+#include "hostsim.h"
+
+#define REG(r) ((uintptr_t)&(r))
+#define WITHIN(addr, p) ((addr) >= (uintptr_t)(p) && (addr) < (uintptr_t)(p) + sizeof(*(p)))
+
+SimBusStats_t SimI2CStats, SimSPIStats;
+uint32_t SimI2CTransfersTo[128];
+static void Kick(void);
+
+// --------------------------------------------------------
+// GPIO and EXTI
+// --------------------------------------------------------
+#define PORTS 8 // GPIOA..GPIOH
+#define PORT(i) ((GPIO_TypeDef *)(GPIOA_BASE_NS + 0x400 * (i)))
+static uint16_t levels[PORTS]; // Levels driven onto input pins
+static uint16_t odr[PORTS]; // Output data last seen by the devices
+
+// Pin levels: outputs follow ODR, other modes the external driver
+static uint16_t PortInput(int i) {
+    GPIO_TypeDef *port = PORT(i);
+    uint16_t idr = 0;
+    for (int bit = 0; bit < 16; bit++) {
+        int mode = port->MODER >> 2 * bit & 0b11;
+        if (mode == 0b01 ? port->ODR & 1 << bit : levels[i] & 1 << bit)
+            idr |= 1 << bit;
+    }
+    return idr;
+}
+static void ExtiEdge(int port, int line, bool rising) {
+    if ((EXTI->EXTICR[line / 4] >> 8 * (line % 4) & 0xFF) != (uint32_t)port)
+        return; // Line connected to another port
+    if (!((rising ? EXTI->RTSR1 : EXTI->FTSR1) & 1 << line))
+        return; // Edge not selected
+    if (rising)
+        EXTI->RPR1 |= 1 << line;
+    else
+        EXTI->FPR1 |= 1 << line;
+    if (EXTI->IMR1 & 1 << line)
+        SimIrq(EXTI0_IRQn + line);
+}
+void SimPin(GPIO_TypeDef *port, int bit, int level) {
+    int i = ((uintptr_t)port - GPIOA_BASE_NS) / 0x400;
+    uint16_t mask = 1 << bit;
+    if (!!(levels[i] & mask) == !!level)
+        return;
+    levels[i] ^= mask;
+    if ((port->MODER >> 2 * bit & 0b11) == 0b00)
+        ExtiEdge(i, bit, level); // Only input pins reach the EXTI
+}
+static void GpioWrite(int i, uintptr_t addr) {
+    GPIO_TypeDef *port = PORT(i);
+    if (addr == REG(port->BSRR)) {
+        // Set takes priority over reset, register reads as 0
+        port->ODR = (port->ODR & ~(port->BSRR >> 16)) | (port->BSRR & 0xFFFF);
+        port->BSRR = 0;
+    }
+    else if (addr == REG(port->BRR)) {
+        port->ODR &= ~port->BRR;
+        port->BRR = 0;
+    }
+    if (port->ODR != odr[i]) {
+        odr[i] = port->ODR;
+        SimDevicePins(i, odr[i]);
+    }
+}
+static void ExtiWrite(uintptr_t addr, uint32_t old) {
+    // Pending registers are write-1-to-clear
+    if (addr == REG(EXTI->RPR1))
+        EXTI->RPR1 = old & ~EXTI->RPR1;
+    else if (addr == REG(EXTI->FPR1))
+        EXTI->FPR1 = old & ~EXTI->FPR1;
+}
+
+// --------------------------------------------------------
+// Timers
+// --------------------------------------------------------
+typedef struct {
+    TIM_TypeDef *regs;
+    IRQn_Type irq; // Update interrupt
+    SimEvent_t update;
+} Timer_t;
+static Timer_t timers[] = {
+    {TIM1, TIM1_UP_IRQn}, {TIM2, TIM2_IRQn}, {TIM3, TIM3_IRQn},
+    {TIM4, TIM4_IRQn}, {TIM5, TIM5_IRQn}, {TIM6, TIM6_IRQn},
+    {TIM7, TIM7_IRQn}, {TIM8, TIM8_UP_IRQn}
+};
+#define TIMERS (sizeof(timers) / sizeof(timers[0]))
+
+// Cycles between update events of the prescaler, counter and repetition counter
+static SimTime_t TimerPeriod(TIM_TypeDef *tim) {
+    SimTime_t cycles = (SimTime_t)(tim->PSC + 1) * ((tim->ARR & 0xFFFF) + 1);
+    if (tim == TIM1 || tim == TIM8)
+        cycles *= (tim->RCR & 0xFFFF) + 1;
+    return cycles;
+}
+static void TimerUpdate(void *arg) {
+    Timer_t *t = arg;
+    t->regs->SR |= TIM_SR_UIF;
+    if (t->regs->DIER & TIM_DIER_UIE)
+        SimIrq(t->irq);
+    if (t->regs->CR1 & TIM_CR1_CEN)
+        SimAt(&t->update, SimNow() + TimerPeriod(t->regs));
+}
+static void TimerWrite(Timer_t *t, uintptr_t addr, uint32_t old) {
+    TIM_TypeDef *tim = t->regs;
+    if (addr == REG(tim->SR))
+        tim->SR = old & tim->SR; // Flags are cleared by writing 0
+    else if (addr == REG(tim->EGR) && tim->EGR & TIM_EGR_UG) {
+        // Update generation restarts the count
+        tim->EGR = 0;
+        SimCancel(&t->update);
+        TimerUpdate(t);
+    }
+    else if (addr == REG(tim->CR1)) {
+        if (!(old & TIM_CR1_CEN) && tim->CR1 & TIM_CR1_CEN)
+            SimAt(&t->update, SimNow() + TimerPeriod(tim));
+        else if (!(tim->CR1 & TIM_CR1_CEN))
+            SimCancel(&t->update);
+    }
+}
+
+// --------------------------------------------------------
+// ADC
+// --------------------------------------------------------
+#define ADC_CONVERSION_CYCLES 15 // 2.5 sampling + 12.5 conversion at HCLK/1
+static uint16_t pot = 0;
+static void AdcEndOfConversion(void *arg);
+static SimEvent_t conversion = {.fn = AdcEndOfConversion};
+
+void SimPot(uint16_t value) {
+    pot = value & 0xFFF;
+}
+static void AdcEndOfConversion(void *arg) {
+    ADC1->DR = pot;
+    ADC1->ISR |= ADC_ISR_EOC | ADC_ISR_EOS;
+    ADC1->CR &= ~ADC_CR_ADSTART;
+    if (ADC1->IER & ADC_IER_EOCIE)
+        SimIrq(ADC1_2_IRQn);
+}
+static void AdcAccess(uintptr_t addr, bool write, uint32_t old) {
+    if (!write) {
+        if (addr == REG(ADC1->DR))
+            ADC1->ISR &= ~ADC_ISR_EOC; // Cleared by reading the data
+        return;
+    }
+    if (addr == REG(ADC1->ISR))
+        ADC1->ISR = old & ~ADC1->ISR; // Write-1-to-clear
+    else if (addr == REG(ADC1->CR)) {
+        if (ADC1->CR & ADC_CR_ADEN)
+            ADC1->ISR |= ADC_ISR_ADRDY;
+        if (!(old & ADC_CR_ADSTART) && ADC1->CR & ADC_CR_ADSTART)
+            SimAt(&conversion, SimNow() + ADC_CONVERSION_CYCLES);
+    }
+}
+
+// --------------------------------------------------------
+// DMA with request multiplexer
+// --------------------------------------------------------
+#define DMA_CHANNELS 8
+#define DMA_CHANNEL(k) ((DMA_Channel_TypeDef *)((uintptr_t)DMA1_Channel1 + 0x14 * (k)))
+static uint32_t dmaOffset[DMA_CHANNELS]; // Bytes moved since enabled
+
+// Enabled channel with transfers left serving a request line, or -1
+static int DmaChannel(int request) {
+    for (int k = 0; k < DMA_CHANNELS; k++) {
+        DMA_Channel_TypeDef *ch = DMA_CHANNEL(k);
+        if ((int)(DMAMUX1_Channel0[k].CCR & DMAMUX_CxCR_DMAREQ_ID) == request
+            && ch->CCR & DMA_CCR_EN && ch->CNDTR != 0)
+            return k;
+    }
+    return -1;
+}
+// One byte moved: advance the memory address, flag completion
+static uint8_t *DmaStep(int k) {
+    DMA_Channel_TypeDef *ch = DMA_CHANNEL(k);
+    uint8_t *mem = (uint8_t *)(uintptr_t)(ch->CM0AR + dmaOffset[k]);
+    if (ch->CCR & DMA_CCR_MINC)
+        dmaOffset[k]++;
+    if (--ch->CNDTR == 0) {
+        DMA1->ISR |= (DMA_ISR_GIF1 | DMA_ISR_TCIF1) << 4 * k;
+        if (ch->CCR & DMA_CCR_TCIE)
+            SimIrq(DMA1_Channel1_IRQn + k);
+    }
+    return mem;
+}
+bool SimDmaRead(int request, uint8_t *data) {
+    int k = DmaChannel(request);
+    if (k < 0 || !(DMA_CHANNEL(k)->CCR & DMA_CCR_DIR))
+        return false;
+    *data = *DmaStep(k);
+    return true;
+}
+bool SimDmaWrite(int request, uint8_t data) {
+    int k = DmaChannel(request);
+    if (k < 0 || DMA_CHANNEL(k)->CCR & DMA_CCR_DIR)
+        return false;
+    *DmaStep(k) = data;
+    return true;
+}
+static void DmaWrite(uintptr_t addr, uint32_t old) {
+    if (addr == REG(DMA1->IFCR)) {
+        // Each global clear bit clears the 4 flags of its channel
+        uint32_t clear = DMA1->IFCR;
+        for (int k = 0; k < DMA_CHANNELS; k++)
+            if (clear & DMA_IFCR_CGIF1 << 4 * k)
+                clear |= 0xF << 4 * k;
+        DMA1->ISR &= ~clear;
+        DMA1->IFCR = 0;
+        return;
+    }
+    for (int k = 0; k < DMA_CHANNELS; k++)
+        if (addr == REG(DMA_CHANNEL(k)->CCR) && !(old & DMA_CCR_EN)
+            && DMA_CHANNEL(k)->CCR & DMA_CCR_EN) {
+            dmaOffset[k] = 0;
+            Kick(); // A peripheral may be waiting for the channel
+        }
+}
+
+// --------------------------------------------------------
+// I2C controllers
+// --------------------------------------------------------
+#define I2C_CLEAR_FLAGS 0x3F38 // Flags with a bit in ICR
+typedef struct {
+    I2C_TypeDef *regs;
+    IRQn_Type ev, er;
+    int dmaRx, dmaTx; // DMAMUX request lines
+    SimEvent_t step;
+    enum {IDLE, ADDRESS, TXDATA, RXDATA, HOLD, STOPPING} state;
+    const SimI2CDevice_t *dev;
+    int left; // Bytes of NBYTES still on the wire
+    int toLoad; // Bytes still to be written to TXDR
+    bool txFull; // TXDR holds a byte
+    bool shifting; // Byte on the wire
+    bool stalled; // Clock stretched until RXDR is read
+    bool startPending; // START requested while the STOP goes out
+    uint8_t shift;
+    SimTime_t since; // Bus busy since
+} I2C_t;
+static void I2CStep(void *arg);
+static I2C_t i2cs[] = {
+    {I2C1, I2C1_EV_IRQn, I2C1_ER_IRQn, 17, 18},
+    {I2C2, I2C2_EV_IRQn, I2C2_ER_IRQn, 19, 20},
+    {I2C3, I2C3_EV_IRQn, I2C3_ER_IRQn, 21, 22},
+    {I2C4, I2C4_EV_IRQn, I2C4_ER_IRQn, 23, 24}
+};
+#define I2CS (sizeof(i2cs) / sizeof(i2cs[0]))
+
+// Cycles per SCL period, from the TIMINGR prescaler and low/high periods
+static SimTime_t I2CBit(I2C_TypeDef *i2c) {
+    uint32_t t = i2c->TIMINGR;
+    return (SimTime_t)((t >> 28) + 1) * ((t & 0xFF) + 1 + (t >> 8 & 0xFF) + 1);
+}
+// Interrupt lines follow the flags and their enables
+static void I2CIrq(I2C_t *c) {
+    uint32_t isr = c->regs->ISR, cr1 = c->regs->CR1;
+    if ((isr & I2C_ISR_TXIS && cr1 & I2C_CR1_TXIE)
+        || (isr & I2C_ISR_RXNE && cr1 & I2C_CR1_RXIE)
+        || (isr & (I2C_ISR_TC | I2C_ISR_TCR) && cr1 & I2C_CR1_TCIE)
+        || (isr & I2C_ISR_STOPF && cr1 & I2C_CR1_STOPIE)
+        || (isr & I2C_ISR_NACKF && cr1 & I2C_CR1_NACKIE))
+        SimIrq(c->ev);
+    if (isr & (I2C_ISR_BERR | I2C_ISR_ARLO | I2C_ISR_OVR) && cr1 & I2C_CR1_ERRIE)
+        SimIrq(c->er);
+}
+static void I2CStart(I2C_t *c) {
+    if (c->state == IDLE) {
+        c->since = SimNow();
+        c->regs->ISR |= I2C_ISR_BUSY;
+    }
+    c->regs->ISR &= ~(I2C_ISR_TC | I2C_ISR_TCR);
+    c->state = ADDRESS;
+    c->txFull = c->shifting = c->stalled = false;
+    SimI2CStats.transfers++;
+    SimAt(&c->step, SimNow() + 10 * I2CBit(c->regs)); // START and address byte
+}
+static void I2CStop(I2C_t *c) {
+    c->state = STOPPING;
+    SimAt(&c->step, SimNow() + I2CBit(c->regs));
+}
+static void I2CEndOfTransfer(I2C_t *c) {
+    if (c->regs->CR2 & I2C_CR2_AUTOEND)
+        I2CStop(c);
+    else {
+        // Hold the bus until software writes START or STOP
+        c->state = HOLD;
+        c->regs->ISR |= I2C_ISR_TC;
+        I2CIrq(c);
+    }
+}
+// Fill TXDR from DMA, or ask software for the next byte
+static void I2CRefill(I2C_t *c) {
+    if (c->state != TXDATA || c->txFull || c->toLoad == 0)
+        return;
+    if (c->regs->CR1 & I2C_CR1_TXDMAEN) {
+        uint8_t data;
+        if (SimDmaRead(c->dmaTx, &data)) {
+            c->regs->TXDR = data;
+            c->txFull = true;
+            c->toLoad--;
+        }
+    }
+    else if (!(c->regs->ISR & I2C_ISR_TXIS)) {
+        c->regs->ISR |= I2C_ISR_TXIS;
+        I2CIrq(c);
+    }
+}
+// Move TXDR to the shift register
+static void I2CShift(I2C_t *c) {
+    if (c->shifting || !c->txFull)
+        return;
+    c->shift = c->regs->TXDR;
+    c->txFull = false;
+    c->shifting = true;
+    c->regs->ISR |= I2C_ISR_TXE;
+    SimAt(&c->step, SimNow() + 9 * I2CBit(c->regs));
+    I2CRefill(c);
+}
+// Hand a received byte to DMA or RXDR, false while RXDR is still full
+static bool I2CReceive(I2C_t *c, uint8_t data) {
+    if (c->regs->CR1 & I2C_CR1_RXDMAEN && SimDmaWrite(c->dmaRx, data))
+        return true;
+    if (c->regs->ISR & I2C_ISR_RXNE)
+        return false;
+    c->regs->RXDR = data;
+    c->regs->ISR |= I2C_ISR_RXNE;
+    I2CIrq(c);
+    return true;
+}
+static void I2CStep(void *arg) {
+    I2C_t *c = arg;
+    I2C_TypeDef *i2c = c->regs;
+    switch (c->state) {
+    case ADDRESS: {
+        bool read = i2c->CR2 & I2C_CR2_RD_WRN;
+        i2c->CR2 &= ~I2C_CR2_START;
+        SimI2CStats.bytes++;
+        c->dev = SimI2CFind(i2c->CR2 >> 1 & 0x7F);
+        SimI2CTransfersTo[i2c->CR2 >> 1 & 0x7F]++;
+        c->left = c->toLoad = (i2c->CR2 & I2C_CR2_NBYTES) >> I2C_CR2_NBYTES_Pos;
+        if (c->dev == NULL || !c->dev->start(read)) {
+            // Not acknowledged, STOP follows automatically
+            SimI2CStats.nacks++;
+            i2c->ISR |= I2C_ISR_NACKF;
+            I2CIrq(c);
+            I2CStop(c);
+        }
+        else if (c->left == 0)
+            I2CEndOfTransfer(c);
+        else if (read) {
+            c->state = RXDATA;
+            SimAt(&c->step, SimNow() + 9 * I2CBit(i2c));
+        }
+        else {
+            c->state = TXDATA;
+            I2CRefill(c);
+            I2CShift(c);
+        }
+        break;
+    }
+    case TXDATA:
+        c->shifting = false;
+        c->dev->write(c->shift);
+        SimI2CStats.bytes++;
+        if (--c->left == 0)
+            I2CEndOfTransfer(c);
+        else
+            I2CShift(c); // Stretch the clock if TXDR is empty
+        break;
+    case RXDATA:
+        if (!c->stalled) {
+            c->shift = c->dev->read();
+            SimI2CStats.bytes++;
+        }
+        c->stalled = !I2CReceive(c, c->shift);
+        if (c->stalled)
+            break; // Resumed by reading RXDR
+        if (--c->left == 0)
+            I2CEndOfTransfer(c);
+        else
+            SimAt(&c->step, SimNow() + 9 * I2CBit(i2c));
+        break;
+    case STOPPING:
+        c->state = IDLE;
+        if (c->dev != NULL)
+            c->dev->stop();
+        i2c->CR2 &= ~I2C_CR2_STOP;
+        i2c->ISR = (i2c->ISR & ~I2C_ISR_BUSY) | I2C_ISR_STOPF;
+        SimI2CStats.busy += SimNow() - c->since;
+        I2CIrq(c);
+        if (c->startPending) {
+            c->startPending = false;
+            I2CStart(c);
+        }
+        break;
+    default:
+        break;
+    }
+}
+static void I2CAccess(I2C_t *c, uintptr_t addr, bool write, uint32_t old) {
+    I2C_TypeDef *i2c = c->regs;
+    if (!write) {
+        if (addr == REG(i2c->RXDR)) {
+            i2c->ISR &= ~I2C_ISR_RXNE;
+            if (c->stalled)
+                SimAt(&c->step, SimNow() + I2CBit(i2c));
+        }
+        return;
+    }
+    if (addr == REG(i2c->ICR)) {
+        i2c->ISR &= ~(i2c->ICR & I2C_CLEAR_FLAGS);
+        i2c->ICR = 0;
+    }
+    else if (addr == REG(i2c->TXDR)) {
+        if (c->state == TXDATA && !c->txFull && c->toLoad > 0) {
+            c->txFull = true;
+            c->toLoad--;
+            i2c->ISR &= ~(I2C_ISR_TXIS | I2C_ISR_TXE);
+            I2CShift(c);
+        }
+    }
+    else if (addr == REG(i2c->CR2)) {
+        if (i2c->CR2 & I2C_CR2_START) {
+            if (c->state == IDLE || c->state == HOLD)
+                I2CStart(c);
+            else if (c->state == STOPPING)
+                c->startPending = true;
+        }
+        else if (i2c->CR2 & I2C_CR2_STOP && c->state == HOLD) {
+            i2c->ISR &= ~I2C_ISR_TC;
+            I2CStop(c);
+        }
+    }
+    else if (addr == REG(i2c->CR1)) {
+        if (!(i2c->CR1 & I2C_CR1_PE)) {
+            // Software reset
+            SimCancel(&c->step);
+            c->state = IDLE;
+            i2c->ISR = I2C_ISR_TXE;
+            return;
+        }
+        if (i2c->CR1 & ~old & I2C_CR1_TXDMAEN)
+            I2CRefill(c);
+        if (i2c->CR1 & ~old & (I2C_CR1_TXIE | I2C_CR1_RXIE))
+            I2CIrq(c);
+    }
+}
+
+// --------------------------------------------------------
+// SPI controllers
+// --------------------------------------------------------
+#define SPI_FIFO 4
+typedef struct {
+    SPI_TypeDef *regs;
+    IRQn_Type irq;
+    int dmaRx, dmaTx;
+    SimEvent_t step;
+    bool shifting;
+    uint8_t shift;
+    uint8_t txFifo[SPI_FIFO], rxFifo[SPI_FIFO];
+    int txCount, rxCount;
+} SPI_t;
+static void SPIStep(void *arg);
+static SPI_t spis[] = {
+    {SPI1, SPI1_IRQn, 11, 12}, {SPI2, SPI2_IRQn, 13, 14}, {SPI3, SPI3_IRQn, 15, 16}
+};
+#define SPIS (sizeof(spis) / sizeof(spis[0]))
+
+// Status flags from the FIFO levels
+static void SPIStatus(SPI_t *s) {
+    uint32_t sr = s->regs->SR & ~(SPI_SR_RXNE | SPI_SR_TXE | SPI_SR_BSY
+                                  | SPI_SR_FRLVL | SPI_SR_FTLVL);
+    if (s->rxCount > 0)
+        sr |= SPI_SR_RXNE | (uint32_t)s->rxCount << SPI_SR_FRLVL_Pos;
+    if (s->txCount < SPI_FIFO)
+        sr |= SPI_SR_TXE;
+    sr |= (uint32_t)s->txCount << SPI_SR_FTLVL_Pos;
+    if (s->shifting || s->txCount > 0)
+        sr |= SPI_SR_BSY;
+    s->regs->SR = sr;
+    s->regs->DR = s->rxCount > 0 ? s->rxFifo[0] : 0;
+    if ((sr & SPI_SR_RXNE && s->regs->CR2 & SPI_CR2_RXNEIE)
+        || (sr & SPI_SR_TXE && s->regs->CR2 & SPI_CR2_TXEIE))
+        SimIrq(s->irq);
+}
+// Start the next byte from DMA or the transmit FIFO
+static void SPIKick(SPI_t *s) {
+    SPI_TypeDef *spi = s->regs;
+    if (s->shifting || !(spi->CR1 & SPI_CR1_SPE))
+        return;
+    uint8_t data;
+    if (spi->CR2 & SPI_CR2_TXDMAEN && SimDmaRead(s->dmaTx, &data))
+        s->shift = data;
+    else if (s->txCount > 0) {
+        s->shift = s->txFifo[0];
+        memmove(s->txFifo, s->txFifo + 1, --s->txCount);
+    }
+    else
+        return;
+    // 8 bits at PCLK / 2^(BR+1)
+    SimTime_t cycles = 8 * (2 << (spi->CR1 >> SPI_CR1_BR_Pos & 0b111));
+    s->shifting = true;
+    SimSPIStats.bytes++;
+    SimSPIStats.busy += cycles;
+    SimAt(&s->step, SimNow() + cycles);
+    SPIStatus(s);
+}
+static void SPIStep(void *arg) {
+    SPI_t *s = arg;
+    s->shifting = false;
+    uint8_t data = s == &spis[0] ? SimSpiTransfer(s->shift) : 0xFF;
+    if (!(s->regs->CR2 & SPI_CR2_RXDMAEN && SimDmaWrite(s->dmaRx, data))
+        && s->rxCount < SPI_FIFO)
+        s->rxFifo[s->rxCount++] = data;
+    SPIStatus(s);
+    SPIKick(s);
+}
+static void SPIAccess(SPI_t *s, uintptr_t addr, bool write) {
+    SPI_TypeDef *spi = s->regs;
+    if (addr == REG(spi->DR)) {
+        if (write && s->txCount < SPI_FIFO)
+            s->txFifo[s->txCount++] = spi->DR;
+        else if (!write && s->rxCount > 0)
+            memmove(s->rxFifo, s->rxFifo + 1, --s->rxCount);
+        SPIStatus(s);
+    }
+    if (write)
+        SPIKick(s);
+}
+
+// --------------------------------------------------------
+// Register access hooks
+// --------------------------------------------------------
+static void Kick(void) {
+    for (size_t i = 0; i < I2CS; i++)
+        I2CRefill(&i2cs[i]);
+    for (size_t i = 0; i < SPIS; i++)
+        SPIKick(&spis[i]);
+}
+void SimPeriphBefore(uintptr_t addr, bool write) {
+    for (int i = 0; i < PORTS; i++)
+        if (addr == REG(PORT(i)->IDR))
+            PORT(i)->IDR = PortInput(i);
+}
+void SimPeriphAfter(uintptr_t addr, bool write, uint32_t old) {
+    if (addr >= GPIOA_BASE_NS && addr < GPIOA_BASE_NS + 0x400 * PORTS) {
+        if (write)
+            GpioWrite((addr - GPIOA_BASE_NS) / 0x400, addr);
+        return;
+    }
+    if (WITHIN(addr, ADC1)) {
+        AdcAccess(addr, write, old);
+        return;
+    }
+    for (size_t i = 0; i < I2CS; i++)
+        if (WITHIN(addr, i2cs[i].regs)) {
+            I2CAccess(&i2cs[i], addr, write, old);
+            return;
+        }
+    for (size_t i = 0; i < SPIS; i++)
+        if (WITHIN(addr, spis[i].regs)) {
+            SPIAccess(&spis[i], addr, write);
+            return;
+        }
+    if (!write)
+        return;
+    if (WITHIN(addr, EXTI))
+        ExtiWrite(addr, old);
+    else if (addr >= DMA1_BASE_NS && addr < DMAMUX1_BASE_NS)
+        DmaWrite(addr, old);
+    else
+        for (size_t i = 0; i < TIMERS; i++)
+            if (WITHIN(addr, timers[i].regs))
+                TimerWrite(&timers[i], addr, old);
+}
+// Reset values that differ from 0
+void SimPeriphInit(void) {
+    for (int i = 0; i < PORTS; i++)
+        PORT(i)->MODER = 0xFFFFFFFF; // Analog
+    GPIOA->MODER = 0xABFFFFFF;
+    GPIOB->MODER = 0xFFFFFEBF;
+    for (size_t i = 0; i < TIMERS; i++) {
+        timers[i].update.fn = TimerUpdate;
+        timers[i].update.arg = &timers[i];
+        timers[i].regs->ARR = 0xFFFF;
+    }
+    for (size_t i = 0; i < I2CS; i++) {
+        i2cs[i].step.fn = I2CStep;
+        i2cs[i].step.arg = &i2cs[i];
+        i2cs[i].regs->ISR = I2C_ISR_TXE;
+    }
+    for (size_t i = 0; i < SPIS; i++) {
+        spis[i].step.fn = SPIStep;
+        spis[i].step.arg = &spis[i];
+        spis[i].regs->SR = SPI_SR_TXE;
+    }
+    ADC1->CR = ADC_CR_DEEPPWD;
+}
@@ -1,6 +1,7 @@
 #ifndef ENVIRO_H_
 #define ENVIRO_H_
 
-
+void Init_Enviro(void);
+void Task_Enviro(void);
 
 #endif /* ENVIRO_H_ */
@@ -48,9 +48,27 @@ static void RenderMenu(void) {
     }
 }
 
+// Held digits repeat, faster the longer they are held; holding SHIFT
+// clears the entry
+static const TouchGestures_t calcGestures = {
+    .longPress = 800, .repeatDelay = 500, .repeatPeriod = 250,
+    .repeatMin = 80, .repeatAccel = 20, .repeatPads = 0x3FF
+};
+
+// Menu and result keys take presses only, a held key does not repeat
+// into the next selection. Repeats serve TouchEntry() alone.
+static Press_t Pressed(void) {
+    Gesture_t g;
+    while (TouchGesture(CALC, &g))
+        if (g.type == TOUCH_PRESS || g.type == TOUCH_DOUBLE)
+            return g.pad;
+    return NONE;
+}
+
 void Init_Calc (void) {
     DisplayEnable();
     TouchEnable();
+    TouchGestures(CALC, &calcGestures);
     state = MENU;
 }
 
@@ -70,7 +88,7 @@ void Task_Calc (void) {
 
     case PROMPT: {
         if (operation == NONE) {
-            Press_t key = TouchInput(CALC);
+            Press_t key = Pressed();
             if (key == NEXT) {               // toggle menu pages
                 menuPage ^= 1;
                 RenderMenu();
@@ -90,7 +108,7 @@ void Task_Calc (void) {
                     DisplayPrint(CALC,0,"4-Function:");
                     DisplayPrint(CALC,1,"1:+ 2:- 3:* 4:/");
                     {
-                        Press_t pick = TouchInput(CALC);
+                        Press_t pick = Pressed();
                         if (pick>=1 && pick<=4) op4=(uint32_t)pick;
                     }
                     break;
@@ -207,7 +225,7 @@ void Task_Calc (void) {
         break;
 
     case WAIT: {
-        Press_t key = TouchInput(CALC);
+        Press_t key = Pressed();
         if (operation == 7 && sortLen > 16) {
             // paging for sort list
             if (key == NEXT) {
@@ -4,13 +4,18 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <math.h>
 #include "enviro.h"
 #include "spi.h"
 #include "display.h"
 #include "touchpad.h"
 #include "systick.h"
-static enum {WAIT_INIT, GET_PARAMS, WAIT_PARAMS, TRIGGER_MEAS, WAIT_STATUS, MEAS_READY} state;
+static enum {WAIT_INIT, GET_PARAMS, WAIT_PARAMS, TRIGGER_MEAS, WAIT_CONVERSION, MEAS_READY} state;
 #define READ 0x80
+// Oversampling, refer to datasheet Table 20
+#define CTRL_HUM 0x01 // osrs_h x1
+#define CTRL_MEAS 0x40 // osrs_t x2, osrs_p skipped, sleep mode
+#define FORCED 0x01 // Mode bits of ctrl_meas for one measurement
 // --------------------------------------------------------
 // SPI Transfers
 // --------------------------------------------------------
@@ -33,23 +38,35 @@ static const EnvWrite_t txPage0 = {0x73, 0x00};
 static SPI_Xfer_t Page0 = {&EnvSPI, TX, (void *)&txPage0, 2, 1};
 
 
+// Register page in use, re-selected only when it changes
+// Refer to datasheet 5.3.1.1
+static int page;
+static void SelectPage(int p) {
+	if (p != page) {
+		SPI_Request(p ? &Page1 : &Page0);
+		page = p;
+	}
+}
+
+
 // Reset sensor
 // Refer to datasheet 5.3.1.5 and Table 20
-static const EnvWrite_t txResetSensor = {0x60, 0xB6}; // Page 1
+static const EnvWrite_t txResetSensor = {0x60, 0xB6}; // Page 0
 static SPI_Xfer_t ResetSensor = {&EnvSPI, TX, (void *)&txResetSensor, 2, 1};
 
 
 // Read ID
 // Refer to datasheet 5.3.1.6 and Table 20
 static uint8_t rxId[1];
-static const EnvWrite_t txIdAddr = {0x50|READ}; // Page 1
+static const EnvWrite_t txIdAddr = {0x50|READ}; // Page 0
 static SPI_Xfer_t ReadId1 = {&EnvSPI, TX, (void *)&txIdAddr, 1, 0};
 static SPI_Xfer_t ReadId2 = {&EnvSPI, RX, (void *)&rxId[0], 1, 1};
 
 
 // Configure oversampling (temperature and humidity)
-// Refer to datasheet 3.2.1 and Table 20
-static const EnvWrite_t txOvsp[2] = {{0x74, 0x41}, {0x72, 0x01}}; // Page 1
+// Refer to datasheet 3.2.1 and Table 20, ctrl_hum takes effect
+// on the following write to ctrl_meas
+static const EnvWrite_t txOvsp[2] = {{0x72, CTRL_HUM}, {0x74, CTRL_MEAS}}; // Page 1
 static SPI_Xfer_t SetOvsp = {&EnvSPI, TX, (void *)&txOvsp[0], 4, 1};
 
 
@@ -93,32 +110,29 @@ void ProcessHumidityParameters (void) {
 
 // Trigger measurement
 // Refer to datasheet 3.2.1, step 8 (combine with existing settings!)
-static const EnvWrite_t txTrigMeasAddr = {0x74, 0x41}; // Page 1
+static const EnvWrite_t txTrigMeasAddr = {0x74, CTRL_MEAS|FORCED}; // Page 1
 static SPI_Xfer_t TrigMeas = {&EnvSPI, TX, (void *)&txTrigMeasAddr, 2, 1};
 
 
-// Check Status
-// Refer to datasheet 5.3.5.1 and Table 20
-static uint8_t status;
-static const EnvWrite_t txStatusAddr = {0x1D|READ}; // Page 1
-static SPI_Xfer_t Status1 = {&EnvSPI, TX, (void *)&txStatusAddr, 1, 0};
-static SPI_Xfer_t Status2 = {&EnvSPI, RX, (void *)&status, 1, 1};
-
-
-// Read Humidity
-// Refer to datasheet 5.3.4.3 and Table 20
-static uint8_t humidityData[2];
-static const EnvWrite_t txHumAddr = {0x25|READ}; // Page 1
-static SPI_Xfer_t Hum1 = {&EnvSPI, TX, (void *)&txHumAddr, 1, 0};
-static SPI_Xfer_t Hum2 = {&EnvSPI, RX, (void *)&humidityData, 2, 1};
+// Conversion time of one forced measurement, in ms
+// Refer to datasheet 3.2.1 and 5.3.3.3 (TPH and gas switching, wake-up)
+static Time_t MeasTime(void) {
+	static const uint8_t cycles[8] = {0, 1, 2, 4, 8, 16, 16, 16};
+	int n = cycles[CTRL_MEAS >> 5] + cycles[CTRL_MEAS >> 2 & 7] + cycles[CTRL_HUM & 7];
+	int us = n * 1963 + 477 * 4 + 477 * 5 + 500;
+	return (us + 999) / 1000 + 1; // Rounded up, +1 for a partial tick
+}
 
 
-// Read Temperature
-// Refer to datasheet 5.3.4.2 and Table 20
-static uint8_t tempData[3];
-static const EnvWrite_t txTempAddr = {0x22|READ}; // Page 1
-static SPI_Xfer_t Temp1 = {&EnvSPI, TX, (void *)&txTempAddr, 1, 0};
-static SPI_Xfer_t Temp2 = {&EnvSPI, RX, (void *)&tempData, 3, 1};
+// Read status and data fields 0x1D..0x26 in one burst
+// Refer to datasheet 5.3.4, 5.3.5.1 and Table 20
+enum {FIELD_STATUS = 0, FIELD_TEMP = 5, FIELD_HUM = 8, FIELDS = 10};
+static uint8_t fields[FIELDS];
+static const EnvWrite_t txFieldsAddr = {0x1D|READ}; // Page 1
+static SPI_Xfer_t Fields1 = {&EnvSPI, TX, (void *)&txFieldsAddr, 1, 0};
+static SPI_Xfer_t Fields2 = {&EnvSPI, RX, (void *)&fields[0], FIELDS, 1};
+static Time_t measTime; // From MeasTime()
+static Time_t trigTime; // When the running measurement was triggered
 
 
 // --------------------------------------------------------
@@ -132,7 +146,7 @@ static double CalcTemperature() {
 
 
 	// Refer to datasheet 3.3.1 and Table 11
-	temp_adc = tempData[0]<<12|tempData[1]<<4|tempData[2]>>4; ;
+	temp_adc = fields[FIELD_TEMP]<<12|fields[FIELD_TEMP+1]<<4|fields[FIELD_TEMP+2]>>4;
 
 
 	uint16_t par_t1 = par_t[0];
@@ -150,7 +164,7 @@ static double CalcHumidity(double temp_comp) {
 	 double var1, var2, var3, var4, hum_comp;
 	 // Refer to datasheet 3.3.3 and Table 13
 
-	 hum_adc = humidityData[0]<<8|humidityData[1];
+	 hum_adc = fields[FIELD_HUM]<<8|fields[FIELD_HUM+1];
 
 	 uint16_t par_h1 = par_h[0];
 	 uint16_t par_h2 = par_h[1];
@@ -174,9 +188,9 @@ static void ProcessEnvData (void) {
 	humidity = CalcHumidity(temperature);
 
 
-	// Display temperature and humidity to 1 decimal place
-	DisplayPrint(ENVIRO,0,"Hum  %3.1f%%", humidity);
-	DisplayPrint(ENVIRO,1,"Temp %3.1f'C", temperature);
+	// Display temperature and humidity to 1 decimal place, in tenths
+	DisplayPrintFixed(ENVIRO,0,"Hum  %3.1f%%", (int)lround(humidity * 10));
+	DisplayPrintFixed(ENVIRO,1,"Temp %3.1f'C", (int)lround(temperature * 10));
 }
 // --------------------------------------------------------
 // Initialization procedure
@@ -194,11 +208,13 @@ void Init_Enviro (void) {
 
 
  	 //Initialize Humidity/Temperature Sensor
+ 	 // Page unknown until selected, reset returns to page 0
  	 SPI_Request(&Page0);
+ 	 page = 0;
  	 SPI_Request(&ResetSensor);
  	 SPI_Request(&ReadId1);
  	 SPI_Request(&ReadId2);
- 	 SPI_Request(&SetOvsp);
+ 	 measTime = MeasTime();
  	 state = WAIT_INIT;
 }
 
@@ -215,7 +231,7 @@ void Task_Enviro (void) {
 
 	case WAIT_INIT:
 		// Wait for initialization to complete
-		if (!SetOvsp.busy) {
+		if (!ReadId2.busy) {
 			printf("Read ID: %x\n",rxId[0]);
 			if (rxId[0] != 0x61) {
 				printf("ERROR: Read ID incorrect!\n");
@@ -238,13 +254,16 @@ void Task_Enviro (void) {
 		SPI_Request(&ParH2);
 
 
+		// Measurement registers are all on page 1
+		SelectPage(1);
+		SPI_Request(&SetOvsp);
 		state = WAIT_PARAMS;
 		break;
 
 
 	case WAIT_PARAMS:
-		// Wait for reads to complete
-		if (!ParH2.busy) {
+		// Wait for reads and configuration to complete
+		if (!SetOvsp.busy) {
 			// Temperature parameters saved in place
 			// Humidity parameters require some processing
 			ProcessHumidityParameters();
@@ -255,46 +274,43 @@ void Task_Enviro (void) {
 
 	case TRIGGER_MEAS:
 		// Trigger humidity and temperature measurement
-		SPI_Request(&Page1);
+		SelectPage(1);
 		SPI_Request(&TrigMeas);
-		SPI_Request(&Status1);
-		SPI_Request(&Status2);
-		state = WAIT_STATUS;
+		trigTime = TimeNow();
+		state = WAIT_CONVERSION;
 		break;
 
 
-	case WAIT_STATUS:
-		// Wait for status to show complete
-		if (!(Status2.busy)) {
-			if (status & 0x80) {
-				// Read humidity and temperature
-				// Refer to SPI transfers above
-				SPI_Request(&Hum1);
-				SPI_Request(&Hum2);
-
-
-				SPI_Request(&Temp1);
-				SPI_Request(&Temp2);
+	case MEAS_READY:
+		// Wait for the burst read to complete
+		if (Fields2.busy) {
+			break;
+		}
+		if (Fields1.status != SPI_OK || Fields2.status != SPI_OK) {
+			printf("ERROR: sensor read failed\n"); // Drop the sample
+		}
+		else if (fields[FIELD_STATUS] & 0x80) {
+			ProcessEnvData(); // Calculate temperature and humidity
+		}
+		// No new data: the trigger behind the read starts another one
+		state = WAIT_CONVERSION;
+		// fall through, the next conversion may already be due
 
 
-				state = MEAS_READY;
-				break;
-			}
-			else {
-				// Read status again
-				SPI_Request(&Status1);
-				SPI_Request(&Status2);
-			}
+	case WAIT_CONVERSION:
+		// Read once the conversion time has passed, no status polling
+		if (TimePassed(trigTime) < measTime) {
+			break;
 		}
-		break;
+		SPI_Request(&Fields1);
+		SPI_Request(&Fields2);
 
 
-	case MEAS_READY:
-		// Wait for reads to complete
-		if (!Temp2.busy) {
-			ProcessEnvData(); // Calculate temperature and humidity
-			state = TRIGGER_MEAS; // Start the next measurement
-		}
+		// Trigger the next measurement behind the read, it converts
+		// while this one is processed
+		SPI_Request(&TrigMeas);
+		trigTime = TimeNow();
+		state = MEAS_READY;
 		break;
 	}
 }
@@ -31,6 +31,29 @@
 #include "calc.h"
 #include "spi.h"
 #include "enviro.h"
+#include "motor.h"
+#include "scheduler.h"
+#include "profile.h"
+
+// Task table: name, function, period (ms), phase (ms), priority
+// Periods share a 10 ms grid so the core sleeps between releases
+static Task_t tasks[] = {
+    {"Touch",   ScanTouchpad,        20, 0, 0},
+    {"GPIO",    ServiceGPIOEvents,   10, 0, 0},
+    {"IOX",     UpdateIOExpanders,   10, 0, 1},
+    {"Display", UpdateDisplay,       10, 0, 1},
+    {"I2C",     ServiceI2CRequests,  10, 0, 1},
+    {"SPI",     ServiceSPIRequests,  10, 0, 1},
+    {"Alarm",   Task_Alarm,          10, 0, 2},
+    {"Motor",   Task_Motor,          10, 0, 2},
+    {"Game",    Task_Game,           10, 0, 3},
+    {"Calc",    Task_Calc,           20, 0, 3},
+    {"Enviro",  Task_Enviro,        100, 0, 4}, // One sample per run
+#ifdef DEBUG
+    {"Report",  ReportTaskTimes,  10000, 10000, 5}, // First report after a full window
+    {"Profile", ProfileDump,      10000, 10000, 5},
+#endif
+};
 
 int main(void)
 {
@@ -47,25 +70,12 @@ int main(void)
 
     // Enable system services
     StartSysTick();
+    StartScheduler(tasks, sizeof(tasks) / sizeof(tasks[0]));
 
     while (1) {
-        // Run apps
-        Task_Alarm();
-        Task_Game();
-        Task_Calc();
-
-        // Run environment
-        Task_Enviro();
-
-        //motor
-        Task_Motor();
-
-        // Housekeeping
-        UpdateIOExpanders();
-        UpdateDisplay();
-        ScanTouchpad();
-        ServiceI2CRequests();
-        ServiceSPIRequests();
-        WaitForSysTick();
+        // Run apps and housekeeping that are due, then sleep until
+        // the next release or an interrupt
+        RunDueTasks();
+        SleepUntil(NextDueTime());
     }
 }
@@ -11,6 +11,7 @@
 #include "adc.h"
 #include "sysclk.h"
 #include "touchpad.h"
+#include "systick.h"
 
 
 // GPIO pins
@@ -65,11 +66,18 @@ int Ni = 30;
 float di = 0.001;
 
 
+// Encoder pulses are counted in task context (GPIO event queue), the
+// timer interrupt only marks the end of each measurement window
 uint32_t pulsesA = 0;
 uint32_t pulsesB = 0;
-uint32_t timerCount = 0;
+volatile uint32_t timerCount = 0;
 uint32_t totalPulses = 0;
 uint32_t prevTimerCount = 0;
+static uint32_t windowStart = 0; // Cycle count when the window opened
+
+
+// AI1/AI2 levels of each direction, switched in one store
+static PinGroup_t driveCW, driveCCW;
 
 
 // Interrupt callback functions
@@ -81,19 +89,20 @@ static void CallbackEncB(void);
 // Change motor direction
 // Refer to motor driver datasheet
 void MotorDirection(int dir) {
-if (dir == CW) {
-//Clockwise
-GPIO_Output(AI1, LOW);
-GPIO_Output(AI2, HIGH);
-} else {
-//Counter-clockwise
-GPIO_Output(AI1, HIGH);
-GPIO_Output(AI2, LOW);
-}
+if (dir == CW)
+GPIO_GroupWrite(&driveCW); // AI1 low, AI2 high
+else
+GPIO_GroupWrite(&driveCCW); // AI1 high, AI2 low
 }
 
 
 // Initialize app
+// Gain keys (2/5 Np up/down, 3/6 Ni up/down) repeat while held
+static const TouchGestures_t motorGestures = { .repeatDelay = 400,
+.repeatPeriod = 150, .repeatMin = 30, .repeatAccel = 25,
+.repeatPads = 1 << 2 | 1 << 3 | 1 << 5 | 1 << 6 };
+
+
 void Init_Motor(void) {
 
 
@@ -120,6 +129,10 @@ GPIO_Mode(AI2, OUTPUT);
 GPIO_Output(AI2, LOW);
 
 
+const Pin_t drive[] = {AI1, AI2};
+driveCW = GPIO_Group(drive, 2, 0b10);
+driveCCW = GPIO_Group(drive, 2, 0b01);
+
 GPIO_Enable(STBY);
 GPIO_Mode(STBY, OUTPUT);
 GPIO_Output(STBY, HIGH);
@@ -146,8 +159,10 @@ MotorDirection(direction);
 
 
 // Refer to Lab Manual
-rpmScalingFactor = 60.0 / (11.0 * 34.0 * 2.0) * SYSCLK_FREQ / (PWM_RCR + 1)
-/ (PWM_PSC + 1) / (PWM_ARR + 1);
+// RPM per pulse per cycle: the window is timed with the cycle counter
+rpmScalingFactor = 60.0 / (11.0 * 34.0 * 2.0) * SYSCLK_FREQ;
+windowStart = TimeNowCycles();
+TouchGestures(MOTOR, &motorGestures);
 }
 
 
@@ -160,7 +175,14 @@ desiredRPM = motorDrivePercentage * MAX_SPEED;
 
 
 if (timerCount - prevTimerCount > 0) {
-float measuredRPM = (float) totalPulses * rpmScalingFactor;
+// Close the window: pulses since the last one over the time it took
+uint32_t now = TimeNowCycles();
+totalPulses = pulsesA + pulsesB;
+pulsesA = 0;
+pulsesB = 0;
+float measuredRPM = (float) totalPulses * rpmScalingFactor
+/ (float) (now - windowStart);
+windowStart = now;
 
 
 if (loopMode == OL) {
@@ -193,9 +215,9 @@ errorSum = errorRpmSum / MAX_SPEED * (float) (PWM_ARR + 1);
 TimerOutput(Motor, round((Kp * error + Ki * errorSum)));
 if (loopMode == CLT) {
 // Display status for Closed Loop mode /w tuning enabled
-DisplayPrint(MOTOR, 0, "Kp:%2.1f %3d RPM", Kp,
+DisplayPrintFixed(MOTOR, 0, "Kp:%2.1f %3d RPM", (int) lroundf(Kp * 10),
 (int) desiredRPM);
-DisplayPrint(MOTOR, 1, "Ki:%1.3f %3d RPM", Ki,
+DisplayPrintFixed(MOTOR, 1, "Ki:%1.3f %3d RPM", (int) lroundf(Ki * 1000),
 (int) measuredRPM);
 } else {
 // Display status for normal Closed Loop mode
@@ -269,9 +291,6 @@ break;
 // Timer 1 update
 void CallbackMotor(void) {
 timerCount++;
-totalPulses = pulsesA + pulsesB;
-pulsesA = 0;
-pulsesB = 0;
 }
 
 
@@ -5,6 +5,7 @@
 #include "timer.h"
 #include "gpio.h"
 #include "sysclk.h"
+#include "profile.h"
 // --------------------------------------------------------
 // Initialization
 // --------------------------------------------------------
@@ -113,6 +114,7 @@ __COMPILER_BARRIER();
 }
 // Interrupt handler for all timers
 static void TimerIRQHandler(TIM_TypeDef *TIM, int i, int IRQn) {
+PROFILE_BEGIN(TimerIRQ);
 // Callback function pointer
 void (*fp)(void);
 // Clear pending IRQ
@@ -126,6 +128,7 @@ UpdateTimerRegisters(TIM);
 fp(); // Invoke callback
 }
 }
+PROFILE_END(TimerIRQ);
 }
 // Dispatch all Timer IRQs to common handler function
 void TIM1_UP_IRQHandler() { TimerIRQHandler(TIM1, 1, TIM1_UP_IRQn); }
@@ -0,0 +1,12 @@
+#ifndef DRIVERS_CONFIG_H_
+#define DRIVERS_CONFIG_H_
+
+// Build options of the shared drivers (stm32-drivers) for this image
+//#define NDISPLAY  // No LCD: display calls compile out
+//#define NPROFILE  // Compile out PROFILE_BEGIN/END regions
+//#define IOX_INT_PIN {GPIOx, n}  // I/O expander INT on an EXTI pin: read buttons on change
+//#define IOX_POLL_MS 20  // I/O expander button read period (ms)
+//#define TOUCH_INT_PIN {GPIOx, n}  // Touchpad IRQ on an EXTI pin: read touches on change
+//#define TOUCH_POLL_MS 20  // Touchpad status read period (ms)
+
+#endif /* DRIVERS_CONFIG_H_ */
@@ -21,6 +21,7 @@ int main (void){
 		Task_Game();
 
 
+		ServiceGPIOEvents();
 		UpdateIOExpanders();
 		UpdateDisplay();
 		ServiceI2CRequests();
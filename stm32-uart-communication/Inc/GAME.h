@@ -1,8 +0,0 @@
-
-#ifndef GAME_H_
-#define GAME_H_
-
-void InitGame();
-void Task_Game();
-
-#endif /* GAME_H_ */
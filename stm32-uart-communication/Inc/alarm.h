@@ -1,7 +0,0 @@
-#ifndef ALARM_H_
-#define ALARM_H_
-
-void Init_Alarm();
-void Task_Alarm();
-
-#endif /* ALARM_H_ */
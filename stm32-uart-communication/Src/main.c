@@ -47,6 +47,7 @@ int main(void)
         Task_Calc();
 
         // Housekeeping
+        ServiceGPIOEvents();
         UpdateIOExpanders();
         UpdateDisplay();
         ScanTouchpad();